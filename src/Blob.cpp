@@ -0,0 +1,43 @@
+/*
+ * Blob.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/Blob.H"
+
+#include <cstdio>
+
+
+string blobsToText(unsigned long seq, const vector<Blob> &blobs){
+	char item[128];
+	sprintf(item, "[SEQ=%lu,N=%d", seq, (int) blobs.size());
+	string text(item);
+	for(size_t k = 0; k < blobs.size(); k++){
+		const Blob &b = blobs[k];
+		sprintf(item, ",%d:%d:%d:%d:%d:%.1f:%.1f", b.minX, b.minY, b.maxX, b.maxY, b.area, b.centroidX, b.centroidY);
+		text += string(item);
+	};
+	text += string("]");
+	return text;
+}
+
+
+bool blobsFromText(const char *text, unsigned long *seq, vector<Blob> *blobs){
+	int n, used;
+	blobs->clear();
+	if(sscanf(text, "[SEQ=%lu,N=%d%n", seq, &n, &used) != 2){
+		return false;
+	};
+	text += used;
+	for(int k = 0; k < n; k++){
+		Blob b;
+		if(sscanf(text, ",%d:%d:%d:%d:%d:%lf:%lf%n", &b.minX, &b.minY, &b.maxX, &b.maxY, &b.area,
+				&b.centroidX, &b.centroidY, &used) != 7){
+			return false;
+		};
+		text += used;
+		blobs->push_back(b);
+	};
+	return (*text == ']');
+}
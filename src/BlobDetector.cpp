@@ -9,20 +9,34 @@
 
 #include <string>
 #include <iostream>
+#include <cstring>
+#include <sys/time.h>
 
 using namespace std;
 
+// coordinates held at the same time by the callers of latest()
+#define ASYNC_READERS 4
+// getBlobCoord() of the asynchronous mode waits for the first coordinate
+#define ASYNC_FIRST_WAIT_MS 1000
+
 namespace BlobDetector{
 
 BlobDetector::BlobDetector(){
 	stdImgSrvVersion_ = string("not connected yet");
 	dataSize_ = 4;
 	receivedData_ =  new unsigned char[dataSize_];
+	callback_    = NULL;
+	callbackArg_ = NULL;
+	asyncLost_   = false;
+	pthread_mutex_init(&asyncMutex_, NULL);
+	pthread_cond_init(&asyncCond_, NULL);
 }
 
 BlobDetector::~BlobDetector(){
 	this->close();
 	delete [] receivedData_;
+	pthread_cond_destroy(&asyncCond_);
+	pthread_mutex_destroy(&asyncMutex_);
 }
 
 void BlobDetector::connect(char *host, unsigned short port){
@@ -32,73 +46,56 @@ void BlobDetector::connect(char *host, unsigned short port){
 
 	// client for image data
 	try{
-		dataSource_ = new TCPSocket(host, port);
-	}catch(...){
+		dataSource_ = new StdImgClient(host, port);
+		host_ = string(host);
+		port_ = port;
+	}catch(string msg){
 		dataSource_ = NULL;
-		string msg("No server for blob data.\n");
-		msg += string(host);
-		msg += string("\n\n");
 		throw msg;
 	};
 
 	try{
-		receiveMetaDataStdImgSrv(host,port);
+		checkMetaData();
 	}catch(string msg){
 		this->close();
 		throw msg;
-	}catch(...){
-		this->close();
-		throw string("unknown error");
 	}
-
+	stdImgSrvVersion_ = dataSource_->version();
+	if(dataSource_->frameSize() > dataSize_){
+		delete [] receivedData_;
+		dataSize_     = dataSource_->frameSize();
+		receivedData_ = new unsigned char[dataSize_];
+	}
 }
 
 void BlobDetector::close(){
+	stopAsync();
 	if(dataSource_ != NULL){
-		dataSource_->cleanUp();
 		stdImgSrvVersion_ = string("not connected yet");
 		delete dataSource_;
 		dataSource_ = NULL;
 	}
 }
 
-void BlobDetector::updateImageData(TCPSocket *socket, unsigned char *storageImageData, int size){
-	int rcvBufferSize = size;
-	int idx = 0;
-	int bytesReceived = 0;
-	int totalBytesReceived = 0;
-	try{
-		socket->send(GET_IMAGE_DATA,strlen(GET_IMAGE_DATA));
-	}catch(SocketException &e){
-		throw string(e.what());
-	}catch(...){
-		string msg("Error while sending: ");
-		msg += string(GET_IMAGE_DATA);
-		throw msg;
-	};
-
-	do{
-		bytesReceived = socket->recv(&(storageImageData[idx]),rcvBufferSize);
-		totalBytesReceived += bytesReceived;
-		idx = totalBytesReceived;
-	}while(totalBytesReceived < size);
-
-	return;
-};
-
 
 void BlobDetector::getBlobCoord(int *X, int *Y){
 	if(dataSource_ == NULL){
 		throw string("not connected yet");
 	}
 
-	//
-	try{
-		this->updateImageData(dataSource_, receivedData_, dataSize_);
-	}catch(string msg){
-		throw msg;
-	}catch(...){
-		throw string("unknown error while reading image data.");
+	// no round trip in the asynchronous mode
+	if(stream_ != NULL){
+		BlobCoord coord;
+		if(!latest(&coord) && !waitNext(&coord, ASYNC_FIRST_WAIT_MS)){
+			throw string("No blob coordinate received from the blob detector.");
+		}
+		*X = coord.x;
+		*Y = coord.y;
+		return;
+	}
+
+	if(!dataSource_->receive(receivedData_)){
+		throw string("Connection to the blob detector lost.");
 	}
 
 	int bloobCoordWidth = 0;
@@ -119,6 +116,24 @@ void BlobDetector::getBlobCoord(int *X, int *Y){
 }
 
 
+void BlobDetector::getBlobs(vector<Blob> *blobs, unsigned long *seq){
+	if(dataSource_ == NULL){
+		throw string("not connected yet");
+	}
+
+	// text of variable length, up to the closing bracket
+	string text = dataSource_->request(GET_BLOBS);
+
+	unsigned long frameSeq;
+	if(!blobsFromText(text.c_str(), &frameSeq, blobs)){
+		throw string("Can't interpret blobs: ") + text;
+	}
+	if(seq != NULL){
+		*seq = frameSeq;
+	}
+}
+
+
 string BlobDetector::version(){
 	if(dataSource_ == NULL){
 		throw string("not connected yet");
@@ -127,64 +142,128 @@ string BlobDetector::version(){
 }
 
 
-void BlobDetector::receiveMetaDataStdImgSrv(char *host, unsigned short port){
-	int sizeEchoBufferMetaData = 64;
-	char echoBufferMetaData[sizeEchoBufferMetaData];
-	int bytesReceived = 0;
+void BlobDetector::checkMetaData(){
+	const StdImgMetaData &meta = dataSource_->metaData();
 
-	try{
-		dataSource_->send(GET_VERSION,strlen(GET_VERSION));
-	}catch(...){
-		string msg("Error while sending: ");
-		msg += string(GET_VERSION);
-		msg += string("\n\n");
-		throw msg;
-	};
+	if(meta.color > 0){
+		throw string("Received data are not grey valued.");
+	}
 
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		string msg("Can't get Standard Image Data Server Version, terminate process.\n");
-		throw msg;
-	};
+	if((meta.height != 1) || (meta.width != 4)){
+		throw string("Received data have not not 1x4 format.");
+	}
 
-	echoBufferMetaData[bytesReceived]='\0';
-	stdImgSrvVersion_ = string(echoBufferMetaData);
+}
 
-	try{
-		dataSource_->send(GET_META_DATA,strlen(GET_META_DATA));
-	}catch(...){
-		string msg("Error while sending: ");
-		msg += string(GET_META_DATA);
-		msg += string("\n\n");
-		throw msg;
-	};
 
-	echoBufferMetaData[0]='\0';
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		throw string("Can't get image meta data.\n");
-	};
+void BlobDetector::startAsync(BlobCoordCallback callback, void *arg){
+	if(dataSource_ == NULL){
+		throw string("not connected yet");
+	}
+	if(stream_ != NULL){
+		return;
+	}
 
-	// interpret received data
-	int  imageWidth_, imageHeight_;
-	char imageOrg_;
-	int  color_;
-	char ch1_, ch2_, ch3_;
-	int  recvImageDataSize_;
-	int  nmbBytesTimeStamp_;
-
-	int nmbTokens = sscanf(echoBufferMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
-			&imageWidth_,&imageHeight_,&imageOrg_,&color_,&ch1_,&ch2_,&ch3_,&recvImageDataSize_,&nmbBytesTimeStamp_);
-	if(nmbTokens != 9){
-		throw string("Can't interpret image meta data, terminate process.\n");
-	};
+	// the subscription occupies a connection of its own
+	StdImgClient *stream = new StdImgClient(host_, port_);
+	stream->subscribe();
+
+	callback_    = callback;
+	callbackArg_ = arg;
+	asyncLost_   = false;
+	coords_      = new LatestFrameSlot(sizeof(BlobCoord), ASYNC_READERS);
+	stream_      = stream;
+	if(pthread_create(&asyncThread_, NULL, runAsync, this) != 0){
+		delete stream_;
+		delete coords_;
+		stream_ = NULL;
+		coords_ = NULL;
+		throw string("Can't start the thread of the asynchronous mode.");
+	}
+}
 
-	if(color_ > 0){
-		throw string("Received data are not grey valued.");
+
+void BlobDetector::stopAsync(){
+	if(stream_ == NULL){
+		return;
 	}
+	stream_->shutdown();
+	pthread_join(asyncThread_, NULL);
+	delete stream_;
+	delete coords_;
+	stream_ = NULL;
+	coords_ = NULL;
+}
 
-	if((imageHeight_ != 1) || (imageWidth_ != 4)){
-		throw string("Received data have not not 1x4 format.");
+
+void *BlobDetector::runAsync(void *detector){
+	((BlobDetector *) detector)->asyncLoop();
+	return NULL;
+}
+
+
+void BlobDetector::asyncLoop(){
+	unsigned char data[4];
+	BlobCoord coord;
+	while(stream_->receivePushed(data, &coord.seq, &coord.timeStamp)){
+		coord.x = (((int) data[1]) << 8) | ((int) data[0]);
+		coord.y = (((int) data[3]) << 8) | ((int) data[2]);
+
+		// skipped if the readers hold all buffers
+		unsigned char *buffer = coords_->writeBuffer();
+		if(buffer != NULL){
+			memcpy(buffer, &coord, sizeof(coord));
+			pthread_mutex_lock(&asyncMutex_);
+			coords_->publish(coord.timeStamp);
+			pthread_cond_broadcast(&asyncCond_);
+			pthread_mutex_unlock(&asyncMutex_);
+		}
+
+		if(callback_ != NULL){
+			callback_(coord, callbackArg_);
+		}
+	}
+
+	pthread_mutex_lock(&asyncMutex_);
+	asyncLost_ = true;
+	pthread_cond_broadcast(&asyncCond_);
+	pthread_mutex_unlock(&asyncMutex_);
+}
+
+
+bool BlobDetector::latest(BlobCoord *coord){
+	LatestFrame frame;
+	if((coords_ == NULL) || !coords_->acquire(&frame)){
+		return false;
+	}
+	memcpy(coord, frame.data, sizeof(BlobCoord));
+	coords_->release(&frame);
+	return true;
+}
+
+
+bool BlobDetector::waitNext(BlobCoord *coord, int timeoutMs){
+	if(coords_ == NULL){
+		throw string("asynchronous mode not started");
+	}
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	long long ns = ((long long) now.tv_usec) * 1000 + ((long long) timeoutMs) * 1000000;
+	struct timespec deadline;
+	deadline.tv_sec  = now.tv_sec + (time_t) (ns / 1000000000);
+	deadline.tv_nsec = (long) (ns % 1000000000);
+
+	pthread_mutex_lock(&asyncMutex_);
+	unsigned long seq = coords_->latestSeq();
+	int rtn = 0;
+	while((coords_->latestSeq() == seq) && !asyncLost_ && (rtn == 0)){
+		rtn = pthread_cond_timedwait(&asyncCond_, &asyncMutex_, &deadline);
 	}
+	bool received = (coords_->latestSeq() != seq);
+	pthread_mutex_unlock(&asyncMutex_);
 
+	return received && latest(coord);
 }
 
 
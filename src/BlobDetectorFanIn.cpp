@@ -0,0 +1,271 @@
+/*
+ * BlobDetectorFanIn.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/BlobDetectorFanIn.H"
+
+#include <cstring>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+// coordinates of a source held at the same time by the callers of latest()
+#define FANIN_READERS 4
+// events handled per wakeup
+#define FANIN_EVENTS 16
+
+namespace BlobDetector{
+
+BlobDetectorFanIn::BlobDetectorFanIn(){
+	callback_    = NULL;
+	callbackArg_ = NULL;
+	started_     = false;
+	poller_      = NULL;
+	wakeup_[0]   = -1;
+	wakeup_[1]   = -1;
+	published_   = 0;
+	lastSource_  = -1;
+	nmbLost_     = 0;
+	wakeups_     = 0;
+	received_    = 0;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&cond_, NULL);
+}
+
+
+BlobDetectorFanIn::~BlobDetectorFanIn(){
+	stop();
+	pthread_cond_destroy(&cond_);
+	pthread_mutex_destroy(&mutex_);
+}
+
+
+int BlobDetectorFanIn::add(const string &host, unsigned short port){
+	if(started_){
+		throw string("sources are added before start()");
+	}
+
+	// a lost connection is not reconnected
+	StdImgClient *client = new StdImgClient(host, port, 0);
+	const StdImgMetaData &meta = client->metaData();
+	if((meta.color > 0) || (meta.width != 4) || (meta.height != 1) || (meta.frameSize() != 4)){
+		delete client;
+		throw string("No blob coordinates from ") + host;
+	}
+
+	Source *source = new Source;
+	source->client = client;
+	source->coords = new LatestFrameSlot(sizeof(BlobCoord), FANIN_READERS);
+	source->have   = 0;
+	source->lost   = false;
+	sources_.push_back(source);
+	return (int) sources_.size() - 1;
+}
+
+
+void BlobDetectorFanIn::start(FanInCallback callback, void *arg){
+	if(started_){
+		return;
+	}
+	callback_    = callback;
+	callbackArg_ = arg;
+
+	if(pipe(wakeup_) < 0){
+		throw string("Can't create the wakeup pipe of the fan-in.");
+	}
+	try{
+		poller_ = new SocketPoller();
+		poller_->add(wakeup_[0], (int) sources_.size());    // the wakeup pipe
+	}catch(SocketException &e){
+		throw string("Can't create the poller of the fan-in: ") + e.what();
+	}
+
+	for(size_t k = 0; k < sources_.size(); k++){
+		sources_[k]->client->subscribe();
+		TCPSocket *socket = sources_[k]->client->socket();
+		try{
+			if(socket == NULL){
+				throw SocketException("not connected");
+			}
+			socket->setBlocking(false);
+			poller_->add(socket, (int) k);
+		}catch(SocketException &e){
+			sources_[k]->lost = true;
+			nmbLost_++;
+		}
+	}
+
+	if(pthread_create(&thread_, NULL, runFanIn, this) != 0){
+		throw string("Can't start the thread of the fan-in.");
+	}
+	started_ = true;
+}
+
+
+void BlobDetectorFanIn::stop(){
+	if(started_){
+		char c = 0;
+		if(write(wakeup_[1], &c, 1) < 0){
+			// the thread ends with the closed pipe as well
+		}
+		pthread_join(thread_, NULL);
+		started_ = false;
+	}
+	if(poller_ != NULL){
+		delete poller_;
+		close(wakeup_[0]);
+		close(wakeup_[1]);
+		poller_ = NULL;
+	}
+	for(size_t k = 0; k < sources_.size(); k++){
+		delete sources_[k]->client;
+		delete sources_[k]->coords;
+		delete sources_[k];
+	}
+	sources_.clear();
+}
+
+
+void *BlobDetectorFanIn::runFanIn(void *fanIn){
+	((BlobDetectorFanIn *) fanIn)->fanInLoop();
+	return NULL;
+}
+
+
+void BlobDetectorFanIn::fanInLoop(){
+	SocketPoller::Event events[FANIN_EVENTS];
+	int wakeup = (int) sources_.size();
+	while(true){
+		int n;
+		try{
+			n = poller_->wait(events, FANIN_EVENTS, -1);
+		}catch(SocketException &e){
+			break;
+		}
+		if(n == 0){
+			continue;
+		}
+		wakeups_++;
+		for(int k = 0; k < n; k++){
+			if(events[k].id == wakeup){
+				return;
+			}
+			int source = events[k].id;
+			if(!receiveAvailable(source)){
+				closeSource(source);
+			}
+		}
+	}
+}
+
+
+bool BlobDetectorFanIn::receiveAvailable(int source){
+	Source *s = sources_[source];
+	int size = (int) sizeof(s->message);
+	while(true){
+		int rtn;
+		try{
+			// non-blocking, -1 once all that is there has been read
+			rtn = s->client->socket()->recv(s->message + s->have, size - s->have);
+		}catch(SocketException &e){
+			return false;
+		}
+		if(rtn < 0){
+			return true;
+		}
+		if(rtn == 0){
+			return false;
+		}
+		s->have += rtn;
+		if(s->have == size){
+			s->have = 0;
+			deliver(source);
+		}
+	}
+}
+
+
+void BlobDetectorFanIn::deliver(int source){
+	Source *s = sources_[source];
+	BlobCoord coord;
+	uint64_t seq = 0;
+	uint64_t t   = 0;
+	for(int k = 7; k >= 0; k--){
+		seq = (seq << 8) | s->message[k];
+		t   = (t << 8)   | s->message[8 + k];
+	}
+	const unsigned char *data = s->message + SUBSCRIBE_HEADER_SIZE;
+	coord.x         = (((int) data[1]) << 8) | ((int) data[0]);
+	coord.y         = (((int) data[3]) << 8) | ((int) data[2]);
+	coord.seq       = (unsigned long) seq;
+	coord.timeStamp = t;
+	received_++;
+
+	// skipped if the readers hold all buffers
+	unsigned char *buffer = s->coords->writeBuffer();
+	if(buffer != NULL){
+		memcpy(buffer, &coord, sizeof(coord));
+		pthread_mutex_lock(&mutex_);
+		s->coords->publish(coord.timeStamp);
+		published_++;
+		lastSource_ = source;
+		pthread_cond_broadcast(&cond_);
+		pthread_mutex_unlock(&mutex_);
+	}
+
+	if(callback_ != NULL){
+		callback_(source, coord, callbackArg_);
+	}
+}
+
+
+void BlobDetectorFanIn::closeSource(int source){
+	Source *s = sources_[source];
+	poller_->remove(s->client->socket()->getDescriptor());
+	pthread_mutex_lock(&mutex_);
+	s->lost = true;
+	nmbLost_++;
+	pthread_cond_broadcast(&cond_);
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+bool BlobDetectorFanIn::latest(int source, BlobCoord *coord){
+	LatestFrame frame;
+	if((source < 0) || (source >= (int) sources_.size()) || !sources_[source]->coords->acquire(&frame)){
+		return false;
+	}
+	memcpy(coord, frame.data, sizeof(BlobCoord));
+	sources_[source]->coords->release(&frame);
+	return true;
+}
+
+
+bool BlobDetectorFanIn::waitNext(int *source, BlobCoord *coord, int timeoutMs){
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	long long ns = ((long long) now.tv_usec) * 1000 + ((long long) timeoutMs) * 1000000;
+	struct timespec deadline;
+	deadline.tv_sec  = now.tv_sec + (time_t) (ns / 1000000000);
+	deadline.tv_nsec = (long) (ns % 1000000000);
+
+	pthread_mutex_lock(&mutex_);
+	unsigned long published = published_;
+	int rtn = 0;
+	while((published_ == published) && (nmbLost_ < (int) sources_.size()) && (rtn == 0)){
+		rtn = pthread_cond_timedwait(&cond_, &mutex_, &deadline);
+	}
+	bool received = (published_ != published);
+	int  last     = lastSource_;
+	pthread_mutex_unlock(&mutex_);
+
+	if(!received || !latest(last, coord)){
+		return false;
+	}
+	*source = last;
+	return true;
+}
+
+}  // end namespace BlobDetector
@@ -0,0 +1,203 @@
+/*
+ * BlobDetectorStage.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/BlobDetectorStage.H"
+#include "../include/BlobLabeler.H"
+#include "../include/MaxPyramid.H"
+#include "../include/WorkerPool.H"
+#include "../include/StdImgDataServerProtocol.H"
+
+#include <cstdio>
+#include <cstring>
+
+
+// bytes of the output, x and y
+#define BLOB_COORD_SIZE 4
+
+
+BlobDetectorStage::BlobDetectorStage(int width, int height, int labelThreads, int pyramidLevels)
+	: Stage(width, height){
+	detectThresh_ = 0;
+	minBlobArea_  = 4;
+	maxBlobs_     = 32;
+	trackMargin_  = 0;
+	trackBudget_  = 0;
+
+	params_.add("detectThresh", &detectThresh_, 0, 255);
+	params_.add("minBlobArea",  &minBlobArea_,  1, width*height);
+	params_.add("maxBlobs",     &maxBlobs_,     1, MAX_BLOBS);
+	params_.add("trackMargin",  &trackMargin_,  0, width + height);
+	params_.add("trackBudget",  &trackBudget_,  0, height);
+
+	labelPool_ = (labelThreads != 1) ? new WorkerPool(labelThreads) : NULL;
+	labeler_   = new BlobLabeler(labelPool_);
+	pyramid_   = (pyramidLevels > 0) ? new MaxPyramid(pyramidLevels) : NULL;
+	pyramidBuilt_ = false;
+
+	tracking_  = false;
+	searchRow_ = 0;
+	frameSeq_     = 0;
+	blobsPending_ = false;
+	labeledSeq_   = 0;
+	blobsText_    = "[SEQ=0,N=0]";
+	ImgKernels::clearBlobScan(&scan_);
+	window_.x0 = 0;     window_.y0 = 0;
+	window_.x1 = width; window_.y1 = height;
+	allocOutput(BLOB_COORD_SIZE);
+}
+
+
+BlobDetectorStage::~BlobDetectorStage(){
+	delete pyramid_;
+	delete labeler_;
+	delete labelPool_;
+}
+
+
+void BlobDetectorStage::track(int margin, int budget){
+	params_.lock();
+	trackMargin_ = margin;
+	trackBudget_ = budget;
+	params_.unlock();
+}
+
+
+void BlobDetectorStage::process(const unsigned char *grey){
+	params_.lock();
+	int thresh   = detectThresh_;
+	int minArea  = minBlobArea_;
+	int maxBlobs = maxBlobs_;
+	int margin   = trackMargin_;
+	int budget   = trackBudget_;
+	params_.unlock();
+
+	// the pyramid pays off only if the labeling uses it as well
+	bool label = blobsPending_;
+	pyramidBuilt_ = label && (pyramid_ != NULL);
+	if(pyramidBuilt_){
+		pyramid_->build(grey, width_, height_);
+	};
+	detectBlob(grey, thresh, margin, budget);
+	frameSeq_++;
+	if(label){
+		labelBlobs(grey, thresh, minArea, maxBlobs);
+	};
+
+	// centre of the extremes
+	int x, y;
+	if(!blobCoord(&x, &y)){
+		x = 0;
+		y = 0;
+	};
+	output_[0] = ((int)0xFF)   & x;          // 1st 8 bits of x
+	output_[1] = (((int)0xFF00) & x) >> 8;   // 2nd 8 bits of x
+	output_[2] = ((int)0xFF)   & y;          // 1st 8 bits of y
+	output_[3] = (((int)0xFF00) & y) >> 8;   // 2nd 8 bits of y
+}
+
+
+void BlobDetectorStage::labelBlobs(const unsigned char *grey, int thresh, int minArea, int maxBlobs){
+	// all blobs, the largest ones first
+	labeler_->label(grey, width_, height_, thresh, minArea, pyramidBuilt_ ? pyramid_ : NULL);
+	const vector<Blob> &blobs = labeler_->blobs();
+	vector<Blob> reported(blobs.begin(), blobs.begin() + (((int) blobs.size() < maxBlobs) ? (int) blobs.size() : maxBlobs));
+	blobsText_    = blobsToText(frameSeq_, reported);
+	labeledSeq_   = frameSeq_;
+	blobsPending_ = false;
+}
+
+
+bool BlobDetectorStage::blobCoord(int *x, int *y){
+	if(scan_.count == 0){
+		return false;
+	};
+	*x = ((scan_.lastCol - scan_.firstCol) / 2) + scan_.firstCol;
+	*y = ((scan_.lastRow - scan_.firstRow) / 2) + scan_.firstRow;
+	return true;
+}
+
+
+void BlobDetectorStage::detectBlob(const unsigned char *grey, int thresh, int margin, int budget){
+	if(margin < 1){
+		tracking_ = false;
+		window_.x0 = 0;      window_.y0 = 0;
+		window_.x1 = width_; window_.y1 = height_;
+		scanImage(grey, thresh);
+		return;
+	};
+
+	if(tracking_){
+		window_ = trackWindow_;
+		ImgKernels::blobScanWindow(grey, width_, window_.x0, window_.y0, window_.x1, window_.y1, thresh, &scan_);
+		if(scan_.count == 0){
+			// lost, search from where it was seen last
+			tracking_  = false;
+			searchRow_ = window_.y0;
+		};
+	};
+
+	if(!tracking_){
+		int rows = ((budget < 1) || (budget > height_)) ? height_ : budget;
+		if(searchRow_ + rows > height_){
+			searchRow_ = height_ - rows;
+		};
+		window_.x0 = 0;      window_.y0 = searchRow_;
+		window_.x1 = width_; window_.y1 = searchRow_ + rows;
+		if(rows == height_){
+			scanImage(grey, thresh);
+		}else{
+			ImgKernels::blobScanWindow(grey, width_, window_.x0, window_.y0, window_.x1, window_.y1, thresh, &scan_);
+		};
+		searchRow_ = (window_.y1 < height_) ? window_.y1 : 0;
+		tracking_  = (scan_.count > 0);
+	};
+
+	// the window of the next frame, it follows the blob by up to margin
+	// pixels per frame (a blob only partly seen by the search is
+	// completed that way too)
+	if(tracking_){
+		trackWindow_.x0 = (scan_.firstCol - margin > 0) ? scan_.firstCol - margin : 0;
+		trackWindow_.y0 = (scan_.firstRow - margin > 0) ? scan_.firstRow - margin : 0;
+		trackWindow_.x1 = (scan_.lastCol + 1 + margin < width_)  ? scan_.lastCol + 1 + margin : width_;
+		trackWindow_.y1 = (scan_.lastRow + 1 + margin < height_) ? scan_.lastRow + 1 + margin : height_;
+	};
+}
+
+
+void BlobDetectorStage::scanImage(const unsigned char *grey, int thresh){
+	if(pyramidBuilt_){
+		pyramid_->blobScan(thresh, &scan_);
+	}else{
+		ImgKernels::blobScan(grey, width_, height_, thresh, &scan_);
+	};
+}
+
+
+string BlobDetectorStage::metaData(){
+	char meta[124];
+	sprintf(meta, "[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
+			BLOB_COORD_SIZE, 1, 'W', 0, 'X', 'X', 'X', BLOB_COORD_SIZE, 0);
+	return string(meta);
+}
+
+
+bool BlobDetectorStage::command(const char *request, string *reply){
+	if(!(strncmp(GET_BLOBS, request, strlen(GET_BLOBS)))){
+		// called under the lock, process() labels the next frame
+		if((labeledSeq_ != frameSeq_) || (frameSeq_ == 0)){
+			blobsPending_ = true;
+			waitProcessed(seq(), BLOBS_WAIT_MS);
+		};
+		*reply = blobsText_;
+		return true;
+	};
+	return false;
+}
+
+
+string BlobDetectorStage::commands(){
+	return string(" ") + GET_BLOBS + "\n";
+}
@@ -0,0 +1,220 @@
+/*
+ * BlobLabeler.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/BlobLabeler.H"
+#include "../include/ImgKernels.H"
+#include "../include/WorkerPool.H"
+#include "../include/MaxPyramid.H"
+
+#include <algorithm>
+
+
+#define BANDS_PER_THREAD 4
+
+
+static bool largerBlob(const Blob &a, const Blob &b){
+	if(a.area != b.area) return (a.area > b.area);
+	if(a.minY != b.minY) return (a.minY < b.minY);
+	return (a.minX < b.minX);
+}
+
+
+BlobLabeler::BlobLabeler(WorkerPool *pool){
+	pool_   = pool;
+	grey_   = NULL;
+	width_  = 0;
+	thresh_ = 0;
+	blockShift_ = -1;
+}
+
+
+int BlobLabeler::root(vector<int> &parent, int a){
+	while(parent[a] != a){
+		parent[a] = parent[parent[a]];   // path halving
+		a = parent[a];
+	};
+	return a;
+}
+
+
+void BlobLabeler::unite(vector<int> &parent, int a, int b){
+	a = root(parent, a);
+	b = root(parent, b);
+	// the smaller index becomes the root
+	if(a < b){
+		parent[b] = a;
+	}else if(b < a){
+		parent[a] = b;
+	};
+}
+
+
+void BlobLabeler::uniteRows(vector<int> &parent, const Run *prev, int prevBase, int nmbPrev,
+		const Run *cur, int curBase, int nmbCur){
+	// 8-neighbourhood: runs touch if they overlap or meet diagonally
+	int p = 0;
+	for(int c = 0; c < nmbCur; c++){
+		while((p < nmbPrev) && (prev[p].end < cur[c].begin)){
+			p++;
+		};
+		for(int q = p; (q < nmbPrev) && (prev[q].begin <= cur[c].end); q++){
+			unite(parent, curBase + c, prevBase + q);
+		};
+	};
+}
+
+
+void BlobLabeler::extract(Band *b){
+	b->runs.clear();
+	b->rowStart.clear();
+	b->bounds.resize(width_ + 1);
+	for(int i = b->beginRow; i < b->endRow; i++){
+		b->rowStart.push_back((int) b->runs.size());
+		if((blockShift_ >= 0) && !blockRows_[i >> blockShift_]){
+			continue;
+		};
+		int nmbBounds = ImgKernels::thresholdRuns(grey_ + (long) width_*i, width_, thresh_, &b->bounds[0]);
+		for(int k = 0; k < nmbBounds; k += 2){
+			Run r;
+			r.row   = i;
+			r.begin = b->bounds[k];
+			r.end   = b->bounds[k + 1];
+			b->runs.push_back(r);
+		};
+	};
+	b->rowStart.push_back((int) b->runs.size());
+
+	b->parent.resize(b->runs.size());
+	for(size_t k = 0; k < b->runs.size(); k++){
+		b->parent[k] = (int) k;
+	};
+	for(int i = 1; i < b->endRow - b->beginRow; i++){
+		int prevBegin = b->rowStart[i - 1];
+		int curBegin  = b->rowStart[i];
+		int curEnd    = b->rowStart[i + 1];
+		if((curBegin == curEnd) || (prevBegin == curBegin)){
+			continue;
+		};
+		uniteRows(b->parent, &b->runs[prevBegin], prevBegin, curBegin - prevBegin,
+				&b->runs[curBegin], curBegin, curEnd - curBegin);
+	};
+}
+
+
+void BlobLabeler::labelBand(int band, void *labeler){
+	BlobLabeler *l = (BlobLabeler *) labeler;
+	l->extract(&l->bands_[band]);
+}
+
+
+int BlobLabeler::label(const unsigned char *grey, int width, int height, int thresh, int minArea,
+		MaxPyramid *pyramid){
+	grey_   = grey;
+	width_  = width;
+	thresh_ = thresh;
+	blobs_.clear();
+	if((width < 1) || (height < 1)){
+		return 0;
+	};
+
+	// the rows of blocks holding candidates
+	blockShift_ = -1;
+	if(pyramid != NULL){
+		int top     = pyramid->nmbLevels();
+		int coarseW = pyramid->width(top);
+		blockShift_ = top;
+		blockRows_.resize(pyramid->height(top));
+		blockBounds_.resize(coarseW + 1);
+		for(int i = 0; i < pyramid->height(top); i++){
+			blockRows_[i] = (ImgKernels::thresholdRuns(pyramid->level(top) + (long) coarseW*i, coarseW, thresh,
+					&blockBounds_[0]) > 0);
+		};
+	};
+
+	// runs and unions within the bands
+	int nmbBands = (pool_ != NULL) ? BANDS_PER_THREAD * pool_->nmbThreads() : 1;
+	if(nmbBands > height) nmbBands = height;
+	bands_.resize(nmbBands);
+	for(int k = 0; k < nmbBands; k++){
+		bands_[k].beginRow = WorkerPool::bandBegin(k,     nmbBands, height);
+		bands_[k].endRow   = WorkerPool::bandBegin(k + 1, nmbBands, height);
+	};
+	if(pool_ != NULL){
+		pool_->run(nmbBands, labelBand, this);
+	}else{
+		labelBand(0, this);
+	};
+
+	// all runs in one forest, unions at the band borders
+	vector<int> base(nmbBands + 1, 0);
+	for(int k = 0; k < nmbBands; k++){
+		base[k + 1] = base[k] + (int) bands_[k].runs.size();
+	};
+	int nmbRuns = base[nmbBands];
+	parent_.resize(nmbRuns);
+	for(int k = 0; k < nmbBands; k++){
+		for(size_t r = 0; r < bands_[k].parent.size(); r++){
+			parent_[base[k] + r] = base[k] + bands_[k].parent[r];
+		};
+	};
+	for(int k = 1; k < nmbBands; k++){
+		Band &above = bands_[k - 1];
+		Band &below = bands_[k];
+		int rowsAbove = above.endRow - above.beginRow;
+		int prevBegin = above.rowStart[rowsAbove - 1];
+		int prevEnd   = above.rowStart[rowsAbove];
+		int curEnd    = below.rowStart[1];
+		if((prevBegin == prevEnd) || (curEnd == 0)){
+			continue;
+		};
+		uniteRows(parent_, &above.runs[prevBegin], base[k - 1] + prevBegin, prevEnd - prevBegin,
+				&below.runs[0], base[k], curEnd);
+	};
+
+	// one blob per root, accumulated over its runs
+	vector<int>       blobOf(nmbRuns, -1);
+	vector<long long> sumX, sumY;
+	for(int k = 0; k < nmbBands; k++){
+		const vector<Run> &runs = bands_[k].runs;
+		for(size_t r = 0; r < runs.size(); r++){
+			int rt = root(parent_, base[k] + (int) r);
+			const Run &run = runs[r];
+			int len = run.end - run.begin;
+			if(blobOf[rt] < 0){
+				blobOf[rt] = (int) blobs_.size();
+				Blob b;
+				b.minX = run.begin; b.maxX = run.end - 1;
+				b.minY = run.row;   b.maxY = run.row;
+				b.area = 0;
+				b.centroidX = b.centroidY = 0.0;
+				blobs_.push_back(b);
+				sumX.push_back(0);
+				sumY.push_back(0);
+			};
+			int id = blobOf[rt];
+			Blob &b = blobs_[id];
+			if(run.begin < b.minX)  b.minX = run.begin;
+			if(run.end - 1 > b.maxX) b.maxX = run.end - 1;
+			b.maxY  = run.row;
+			b.area += len;
+			sumX[id] += (long long) (run.begin + run.end - 1) * len / 2;
+			sumY[id] += (long long) run.row * len;
+		};
+	};
+
+	size_t kept = 0;
+	for(size_t id = 0; id < blobs_.size(); id++){
+		if(blobs_[id].area < minArea){
+			continue;
+		};
+		blobs_[id].centroidX = ((double) sumX[id]) / blobs_[id].area;
+		blobs_[id].centroidY = ((double) sumY[id]) / blobs_[id].area;
+		blobs_[kept++] = blobs_[id];
+	};
+	blobs_.resize(kept);
+	sort(blobs_.begin(), blobs_.end(), largerBlob);
+	return (int) blobs_.size();
+}
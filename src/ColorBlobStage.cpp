@@ -0,0 +1,105 @@
+/*
+ * ColorBlobStage.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/ColorBlobStage.H"
+#include "../include/ColorFilterStage.H"
+#include "../include/WorkerPool.H"
+
+#include <cstdio>
+#include <cstring>
+
+
+#define BANDS_PER_THREAD 4
+
+// bytes of the output, x and y
+#define BLOB_COORD_SIZE 4
+
+
+ColorBlobStage::ColorBlobStage(int width, int height, int threads) : Stage(width, height){
+	ColorFilterStage::addParams(params_, &settings_);
+	preparedValid_ = false;
+	detectThresh_  = 0;
+	params_.add("detectThresh", &detectThresh_, 0, 255);
+
+	pool_ = new WorkerPool(threads);
+	rgb_  = NULL;
+	ImgKernels::clearBlobScan(&scan_);
+	allocOutput(BLOB_COORD_SIZE);
+}
+
+
+ColorBlobStage::~ColorBlobStage(){
+	delete pool_;
+}
+
+
+int ColorBlobStage::nmbThreads(){
+	return pool_->nmbThreads();
+}
+
+
+void ColorBlobStage::process(const unsigned char *rgb){
+	ImgKernels::ColorFilterParams p;
+	params_.lock();
+	p       = settings_;
+	thresh_ = detectThresh_;
+	params_.unlock();
+
+	if(!preparedValid_ || (memcmp(&p, &prepared_, sizeof(p)) != 0)){
+		prepared_ = p;
+		ImgKernels::prepareColorFilter(prepared_, &filterPrepared_);
+		preparedValid_ = true;
+	};
+
+	// the bands top down give the result of a single scan
+	rgb_ = rgb;
+	int nmbBands = BANDS_PER_THREAD * pool_->nmbThreads();
+	if(nmbBands > height_) nmbBands = height_;
+	bands_.resize(nmbBands);
+	pool_->run(nmbBands, scanBand, this);
+	ImgKernels::clearBlobScan(&scan_);
+	for(int k = 0; k < nmbBands; k++){
+		ImgKernels::mergeBlobScan(bands_[k], &scan_);
+	};
+
+	int x, y;
+	if(!blobCoord(&x, &y)){
+		x = 0;
+		y = 0;
+	};
+	output_[0] = ((int)0xFF)   & x;          // 1st 8 bits of x
+	output_[1] = (((int)0xFF00) & x) >> 8;   // 2nd 8 bits of x
+	output_[2] = ((int)0xFF)   & y;          // 1st 8 bits of y
+	output_[3] = (((int)0xFF00) & y) >> 8;   // 2nd 8 bits of y
+}
+
+
+void ColorBlobStage::scanBand(int band, void *stage){
+	ColorBlobStage *s = (ColorBlobStage *) stage;
+	int nmbBands = (int) s->bands_.size();
+	int begin = WorkerPool::bandBegin(band,     nmbBands, s->height_);
+	int end   = WorkerPool::bandBegin(band + 1, nmbBands, s->height_);
+	ImgKernels::colorBlobScanWindow(s->rgb_, s->width_, 0, begin, s->width_, end, s->filterPrepared_, s->thresh_,
+			&s->bands_[band]);
+}
+
+
+bool ColorBlobStage::blobCoord(int *x, int *y){
+	if(scan_.count == 0){
+		return false;
+	};
+	*x = ((scan_.lastCol - scan_.firstCol) / 2) + scan_.firstCol;
+	*y = ((scan_.lastRow - scan_.firstRow) / 2) + scan_.firstRow;
+	return true;
+}
+
+
+string ColorBlobStage::metaData(){
+	char meta[124];
+	sprintf(meta, "[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
+			BLOB_COORD_SIZE, 1, 'W', 0, 'X', 'X', 'X', BLOB_COORD_SIZE, 0);
+	return string(meta);
+}
@@ -0,0 +1,126 @@
+/*
+ * ColorFilterStage.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/ColorFilterStage.H"
+#include "../include/WorkerPool.H"
+
+#include <cstdio>
+#include <cstring>
+
+
+// several bands per thread, so that threads which are done early can
+// steal from the others
+#define BANDS_PER_THREAD 4
+
+
+ColorFilterStage::ColorFilterStage(int width, int height, int threads, bool lut) : Stage(width, height){
+	addParams(params_, &settings_);
+	preparedValid_ = false;
+
+	lut_  = lut;
+	pool_ = new WorkerPool(threads);
+	rgb_  = NULL;
+	allocOutput(width * height);
+}
+
+
+void ColorFilterStage::addParams(ParamTable &params, ImgKernels::ColorFilterParams *settings){
+	settings->rFilterThreshR = 162;
+	settings->rFilterThreshG = 143;
+	settings->rFilterThreshB = 255;
+	settings->gFilterThreshR = 126;
+	settings->gFilterThreshG = 140;
+	settings->gFilterThreshB = 209;
+	settings->bFilterThreshR = 87;
+	settings->bFilterThreshG = 255;
+	settings->bFilterThreshB = 149;
+	settings->sumPartR = 0;
+	settings->sumPartG = 0;
+	settings->sumPartB = 0;
+	settings->sumAdd   = 0;
+
+	params.add("rFilterThreshR", &settings->rFilterThreshR, 0, 255);
+	params.add("rFilterThreshG", &settings->rFilterThreshG, 0, 255);
+	params.add("rFilterThreshB", &settings->rFilterThreshB, 0, 255);
+	params.add("gFilterThreshR", &settings->gFilterThreshR, 0, 255);
+	params.add("gFilterThreshG", &settings->gFilterThreshG, 0, 255);
+	params.add("gFilterThreshB", &settings->gFilterThreshB, 0, 255);
+	params.add("bFilterThreshR", &settings->bFilterThreshR, 0, 255);
+	params.add("bFilterThreshG", &settings->bFilterThreshG, 0, 255);
+	params.add("bFilterThreshB", &settings->bFilterThreshB, 0, 255);
+	params.add("sumPartR",       &settings->sumPartR,       0, 100);
+	params.add("sumPartG",       &settings->sumPartG,       0, 100);
+	params.add("sumPartB",       &settings->sumPartB,       0, 100);
+	params.add("sumAdd",         &settings->sumAdd,         0, 255);
+}
+
+
+ColorFilterStage::~ColorFilterStage(){
+	delete pool_;
+}
+
+
+int ColorFilterStage::nmbThreads(){
+	return pool_->nmbThreads();
+}
+
+
+void ColorFilterStage::process(const unsigned char *rgb){
+	filter(rgb, NULL, NULL, NULL, NULL);
+}
+
+
+void ColorFilterStage::filter(const unsigned char *rgb, unsigned char *r, unsigned char *g, unsigned char *b,
+		unsigned char *sum){
+	// a consistent set of parameters, SET_PARAM changes several at once
+	ImgKernels::ColorFilterParams p;
+	params_.lock();
+	p = settings_;
+	params_.unlock();
+
+	if(!preparedValid_ || (memcmp(&p, &prepared_, sizeof(p)) != 0)){
+		prepared_ = p;
+		ImgKernels::prepareColorFilter(prepared_, &filterPrepared_);
+		preparedValid_ = true;
+	};
+
+	rgb_       = rgb;
+	planes_[0] = r;
+	planes_[1] = g;
+	planes_[2] = b;
+	planes_[3] = sum;
+	nmbBands_  = BANDS_PER_THREAD * pool_->nmbThreads();
+	if(nmbBands_ > height_) nmbBands_ = height_;
+	pool_->run(nmbBands_, filterBand, this);
+}
+
+
+void ColorFilterStage::filterBand(int band, void *stage){
+	ColorFilterStage *s = (ColorFilterStage *) stage;
+	int begin = WorkerPool::bandBegin(band,     s->nmbBands_, s->height_);
+	int end   = WorkerPool::bandBegin(band + 1, s->nmbBands_, s->height_);
+
+	int offset = begin * s->width_;
+	unsigned char *planes[4];
+	for(int k = 0; k < 4; k++){
+		planes[k] = (s->planes_[k] != NULL) ? s->planes_[k] + offset : NULL;
+	};
+	if(s->lut_){
+		ImgKernels::colorFilterLut(s->rgb_ + 3*offset, s->width_, end - begin, s->filterPrepared_,
+				planes[0], planes[1], planes[2], planes[3], s->width_, s->output_ + offset);
+	}else{
+		ImgKernels::colorFilter(s->rgb_ + 3*offset, s->width_, end - begin, s->filterPrepared_,
+				planes[0], planes[1], planes[2], planes[3], s->width_, s->output_ + offset);
+	};
+}
+
+
+string ColorFilterStage::metaData(){
+	char meta[124];
+	sprintf(meta, "[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
+			width_, height_, 'W', 0, 'R', 'G', 'B', width_*height_, 0);
+	return string(meta);
+}
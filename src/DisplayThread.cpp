@@ -0,0 +1,70 @@
+/*
+ * DisplayThread.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/DisplayThread.H"
+
+
+#define DEFAULT_DISPLAY_FPS 30.0
+
+
+DisplayThread::DisplayThread(int frameSize, double fps,
+		void (*open)(void *arg), void (*show)(const unsigned char *frame, void *arg), void *arg)
+	: slot_(frameSize, 1), pacer_((fps > 0.0) ? fps : DEFAULT_DISPLAY_FPS){
+	open_    = open;
+	show_    = show;
+	arg_     = arg;
+	started_ = false;
+	stop_    = false;
+	shown_   = 0;
+}
+
+
+DisplayThread::~DisplayThread(){
+	if(started_){
+		stop_ = true;
+		pthread_join(thread_, NULL);
+	};
+}
+
+
+void DisplayThread::start(){
+	if(!started_){
+		started_ = true;
+		pthread_create(&thread_, NULL, runDisplay, this);
+	};
+}
+
+
+void *DisplayThread::runDisplay(void *display){
+	((DisplayThread *) display)->displayLoop();
+	return NULL;
+}
+
+
+void DisplayThread::displayLoop(){
+	if(open_ != NULL){
+		open_(arg_);
+	};
+
+	unsigned long lastSeq = 0;
+	pacer_.start();
+	while(!stop_){
+		LatestFrame frame;
+		if(slot_.acquire(&frame)){
+			if(frame.seq != lastSeq){
+				lastSeq = frame.seq;
+				show_(frame.data, arg_);
+				shown_++;
+			}else{
+				show_(NULL, arg_);
+			};
+			slot_.release(&frame);
+		}else{
+			show_(NULL, arg_);
+		};
+		pacer_.wait();
+	};
+}
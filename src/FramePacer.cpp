@@ -0,0 +1,105 @@
+/*
+ * FramePacer.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/FramePacer.H"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+
+#define NSEC_PER_SEC 1000000000LL
+
+
+static int64_t toNs(const struct timespec &t){
+	return ((int64_t) t.tv_sec) * NSEC_PER_SEC + t.tv_nsec;
+}
+
+static struct timespec fromNs(int64_t ns){
+	struct timespec t;
+	t.tv_sec  = ns / NSEC_PER_SEC;
+	t.tv_nsec = ns % NSEC_PER_SEC;
+	return t;
+}
+
+
+FramePacer::FramePacer(double fps){
+	period_ = (fps > 0.0) ? (int64_t) (((double) NSEC_PER_SEC) / fps) : 0;
+	deadline_.tv_sec  = 0;
+	deadline_.tv_nsec = 0;
+	reset();
+}
+
+
+void FramePacer::start(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	deadline_ = fromNs(toNs(now) + period_);
+	reset();
+}
+
+
+void FramePacer::wait(){
+	if(period_ <= 0){
+		return;
+	};
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline_, NULL) == EINTR){;};
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t deadline = toNs(deadline_);
+	int64_t jitter   = toNs(now) - deadline;
+
+	nmbFrames_++;
+	sumJitter_   += (double) jitter;
+	sumSqJitter_ += ((double) jitter) * ((double) jitter);
+	if(jitter > maxJitter_) maxJitter_ = jitter;
+
+	// next deadline, skip the ones already missed
+	int64_t missed = jitter / period_;
+	nmbMissed_ += (long) missed;
+	deadline_ = fromNs(deadline + (missed + 1) * period_);
+}
+
+
+double FramePacer::meanJitterUs(){
+	if(nmbFrames_ == 0) return 0.0;
+	return (sumJitter_ / nmbFrames_) / 1e3;
+}
+
+
+double FramePacer::stdDevJitterUs(){
+	if(nmbFrames_ == 0) return 0.0;
+	double mean = sumJitter_ / nmbFrames_;
+	double var  = sumSqJitter_ / nmbFrames_ - mean*mean;
+	return (var > 0.0) ? sqrt(var) / 1e3 : 0.0;
+}
+
+
+double FramePacer::maxJitterUs(){
+	return ((double) maxJitter_) / 1e3;
+}
+
+
+string FramePacer::report(){
+	char line[256];
+	snprintf(line, sizeof(line),
+			"frames %ld  missed %ld  jitter mean %.1f us  std %.1f us  max %.1f us",
+			nmbFrames_, nmbMissed_, meanJitterUs(), stdDevJitterUs(), maxJitterUs());
+	return string(line);
+}
+
+
+void FramePacer::reset(){
+	nmbFrames_   = 0;
+	nmbMissed_   = 0;
+	sumJitter_   = 0.0;
+	sumSqJitter_ = 0.0;
+	maxJitter_   = 0;
+}
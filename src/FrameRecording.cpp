@@ -0,0 +1,203 @@
+/*
+ * FrameRecording.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/FrameRecording.H"
+
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+static void writeAll(int fd, const void *data, size_t size){
+	const char *ptr = (const char *) data;
+	while(size > 0){
+		ssize_t n = ::write(fd, ptr, size);
+		if(n < 0){
+			if(errno == EINTR) continue;
+			throw string("Can't write recording: ") + string(strerror(errno));
+		};
+		ptr  += n;
+		size -= n;
+	};
+}
+
+
+// FrameRecorder
+
+FrameRecorder::FrameRecorder(){
+	segmentFd_   = -1;
+	indexFd_     = -1;
+	frameSize_   = 0;
+	frameStride_ = 0;
+	offset_      = 0;
+	nmbFrames_   = 0;
+	padding_     = NULL;
+}
+
+FrameRecorder::~FrameRecorder(){
+	this->close();
+}
+
+void FrameRecorder::open(const char *fileName, const char *version, const char *metaData, int frameSize){
+	this->close();
+
+	string indexName = string(fileName) + string(".idx");
+	segmentFd_ = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	indexFd_   = ::open(indexName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if((segmentFd_ < 0) || (indexFd_ < 0)){
+		string msg = string("Can't create recording ") + string(fileName) + string(": ") + string(strerror(errno));
+		this->close();
+		throw msg;
+	};
+
+	frameSize_   = frameSize;
+	frameStride_ = ((frameSize + RECORDING_FRAME_ALIGN - 1) / RECORDING_FRAME_ALIGN) * RECORDING_FRAME_ALIGN;
+	padding_     = new char[RECORDING_FRAME_ALIGN];
+	memset(padding_, 0, RECORDING_FRAME_ALIGN);
+
+	char header[RECORDING_HEADER_SIZE];
+	memset(header, 0, RECORDING_HEADER_SIZE);
+	RecordingHeader *h = (RecordingHeader *) header;
+	memcpy(h->magic, RECORDING_MAGIC, sizeof(h->magic));
+	strncpy(h->version,  version,  sizeof(h->version)  - 1);
+	strncpy(h->metaData, metaData, sizeof(h->metaData) - 1);
+	h->frameSize = frameSize;
+
+	writeAll(segmentFd_, header, RECORDING_HEADER_SIZE);
+	offset_    = RECORDING_HEADER_SIZE;
+	nmbFrames_ = 0;
+}
+
+void FrameRecorder::append(const unsigned char *frame, uint64_t timeStamp){
+	if(segmentFd_ < 0){
+		throw string("recording not open");
+	};
+
+	// frame first, the index entry makes it visible for replay
+	writeAll(segmentFd_, frame, frameSize_);
+	if(frameStride_ > frameSize_){
+		writeAll(segmentFd_, padding_, frameStride_ - frameSize_);
+	};
+
+	RecordingIndexEntry entry;
+	entry.offset    = offset_;
+	entry.timeStamp = timeStamp;
+	writeAll(indexFd_, &entry, sizeof(entry));
+
+	offset_ += frameStride_;
+	nmbFrames_++;
+}
+
+void FrameRecorder::close(){
+	if(segmentFd_ >= 0) ::close(segmentFd_);
+	if(indexFd_ >= 0)   ::close(indexFd_);
+	segmentFd_ = -1;
+	indexFd_   = -1;
+	delete [] padding_;
+	padding_ = NULL;
+}
+
+
+// FrameRecording
+
+FrameRecording::FrameRecording(){
+	segment_     = NULL;
+	segmentSize_ = 0;
+	index_       = NULL;
+	indexSize_   = 0;
+	nmbFrames_   = 0;
+	frameSize_   = 0;
+}
+
+FrameRecording::~FrameRecording(){
+	this->close();
+}
+
+static void *mapFile(const char *fileName, size_t *size){
+	int fd = ::open(fileName, O_RDONLY);
+	if(fd < 0){
+		throw string("Can't open ") + string(fileName) + string(": ") + string(strerror(errno));
+	};
+
+	struct stat st;
+	if((fstat(fd, &st) < 0) || (st.st_size == 0)){
+		::close(fd);
+		throw string("Can't map empty file ") + string(fileName);
+	};
+
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED){
+		throw string("Can't map ") + string(fileName) + string(": ") + string(strerror(errno));
+	};
+	*size = st.st_size;
+	return data;
+}
+
+void FrameRecording::open(const char *fileName){
+	this->close();
+
+	string indexName = string(fileName) + string(".idx");
+	segment_ = (unsigned char *) mapFile(fileName, &segmentSize_);
+	try{
+		index_ = (RecordingIndexEntry *) mapFile(indexName.c_str(), &indexSize_);
+	}catch(string msg){
+		this->close();
+		throw msg;
+	};
+
+	RecordingHeader *h = (RecordingHeader *) segment_;
+	if((segmentSize_ < RECORDING_HEADER_SIZE) || (memcmp(h->magic, RECORDING_MAGIC, sizeof(h->magic)) != 0)){
+		this->close();
+		throw string(fileName) + string(" is no recording.");
+	};
+
+	frameSize_ = h->frameSize;
+	version_   = string(h->version,  strnlen(h->version,  sizeof(h->version)));
+	metaData_  = string(h->metaData, strnlen(h->metaData, sizeof(h->metaData)));
+
+	// skip index entries of frames not completely written
+	nmbFrames_ = indexSize_ / sizeof(RecordingIndexEntry);
+	while((nmbFrames_ > 0) && (index_[nmbFrames_-1].offset + frameSize_ > segmentSize_)){
+		nmbFrames_--;
+	};
+	if(nmbFrames_ < 1){
+		this->close();
+		throw string(fileName) + string(" contains no frames.");
+	};
+
+	// frames are read in order, let the kernel read ahead
+	madvise(segment_, segmentSize_, MADV_SEQUENTIAL);
+}
+
+void FrameRecording::close(){
+	if(segment_ != NULL) munmap(segment_, segmentSize_);
+	if(index_ != NULL)   munmap(index_, indexSize_);
+	segment_   = NULL;
+	index_     = NULL;
+	nmbFrames_ = 0;
+}
+
+int FrameRecording::frameAt(uint64_t relTime){
+	uint64_t t = index_[0].timeStamp + relTime;
+	int lo = 0;
+	int hi = nmbFrames_ - 1;
+	while(lo < hi){
+		int mid = (lo + hi + 1) / 2;
+		if(index_[mid].timeStamp <= t){
+			lo = mid;
+		}else{
+			hi = mid - 1;
+		};
+	};
+	return lo;
+}
@@ -0,0 +1,299 @@
+/*
+ * FrameSource.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/FrameSource.H"
+#include "../include/ImgKernels.H"
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cctype>
+#include <dirent.h>
+
+using namespace std;
+
+
+/*
+ * CameraSource
+ */
+CameraSource::CameraSource(int device, int color){
+	color_   = color;
+	capture_ = cvCaptureFromCAM(device);
+	IplImage *img = (capture_ != NULL) ? cvQueryFrame(capture_) : NULL;
+	if(img == NULL){
+		if(capture_ != NULL) cvReleaseCapture(&capture_);
+		throw string("Can't capture from camera.\n");
+	};
+	width_  = img->width;
+	height_ = img->height;
+}
+
+
+CameraSource::~CameraSource(){
+	cvReleaseCapture(&capture_);
+}
+
+
+bool CameraSource::nextFrame(unsigned char *imageData){
+	IplImage *img = cvQueryFrame(capture_);
+	if(img == NULL){
+		return false;
+	};
+	if(color_ != 0){
+		ImgKernels::bgrToRgb((uchar *) img->imageData, img->widthStep, img->nChannels, imageData, width_, height_);
+	}else{
+		ImgKernels::bgrToGrey((uchar *) img->imageData, img->widthStep, img->nChannels, imageData, width_, height_);
+	};
+	return true;
+}
+
+
+/*
+ * DecodeAheadSource
+ */
+DecodeAheadSource::DecodeAheadSource(int color, int nmbThreads, int poolSize){
+	color_        = color;
+	width_        = 0;
+	height_       = 0;
+	frameSize_    = 0;
+	nmbThreads_   = (nmbThreads < 1) ? 1 : nmbThreads;
+	nextToDecode_ = 0;
+	nextToServe_  = 0;
+	stop_         = false;
+	running_      = false;
+	ended_        = false;
+
+	// every thread needs a buffer to decode into while one is served
+	if(poolSize < nmbThreads_ + 1) poolSize = nmbThreads_ + 1;
+	pool_.resize(poolSize);
+	for(size_t k = 0; k < pool_.size(); k++){
+		pool_[k].data  = NULL;
+		pool_[k].index = -1;
+		pool_[k].state = SLOT_FREE;
+	};
+
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&changed_, NULL);
+}
+
+
+DecodeAheadSource::~DecodeAheadSource(){
+	stop();
+	for(size_t k = 0; k < pool_.size(); k++){
+		delete [] pool_[k].data;
+	};
+	pthread_cond_destroy(&changed_);
+	pthread_mutex_destroy(&mutex_);
+}
+
+
+void DecodeAheadSource::start(){
+	frameSize_ = width_ * height_ * ((color_ != 0) ? 3 : 1);
+	for(size_t k = 0; k < pool_.size(); k++){
+		pool_[k].data = new unsigned char[frameSize_];
+	};
+
+	threads_.resize(nmbThreads_);
+	for(int t = 0; t < nmbThreads_; t++){
+		pthread_create(&threads_[t], NULL, runDecoder, this);
+	};
+	running_ = true;
+}
+
+
+void DecodeAheadSource::stop(){
+	if(!running_){
+		return;
+	};
+	pthread_mutex_lock(&mutex_);
+	stop_ = true;
+	pthread_cond_broadcast(&changed_);
+	pthread_mutex_unlock(&mutex_);
+
+	for(size_t t = 0; t < threads_.size(); t++){
+		pthread_join(threads_[t], NULL);
+	};
+	running_ = false;
+}
+
+
+void *DecodeAheadSource::runDecoder(void *source){
+	((DecodeAheadSource *) source)->decodeLoop();
+	return NULL;
+}
+
+
+void DecodeAheadSource::decodeLoop(){
+	bool end = false;
+
+	pthread_mutex_lock(&mutex_);
+	while(!stop_ && !end){
+		Slot &slot = pool_[nextToDecode_ % pool_.size()];
+		if(slot.state != SLOT_FREE){
+			// all buffers decoded or in use, wait for nextFrame()
+			pthread_cond_wait(&changed_, &mutex_);
+			continue;
+		};
+
+		long index = nextToDecode_++;
+		slot.index = index;
+		slot.state = SLOT_DECODING;
+		pthread_mutex_unlock(&mutex_);
+
+		bool ok = decode(index, slot.data);
+
+		pthread_mutex_lock(&mutex_);
+		slot.state = ok ? SLOT_READY : SLOT_END;
+		end = !ok;
+		pthread_cond_broadcast(&changed_);
+	};
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+bool DecodeAheadSource::nextFrame(unsigned char *imageData){
+	pthread_mutex_lock(&mutex_);
+	Slot &slot = pool_[nextToServe_ % pool_.size()];
+	while((slot.index != nextToServe_) || ((slot.state != SLOT_READY) && (slot.state != SLOT_END))){
+		pthread_cond_wait(&changed_, &mutex_);
+	};
+	if(slot.state == SLOT_END){
+		ended_ = true;
+		pthread_mutex_unlock(&mutex_);
+		return false;
+	};
+	pthread_mutex_unlock(&mutex_);
+
+	// ready slots belong to the reader
+	memcpy(imageData, slot.data, frameSize_);
+
+	pthread_mutex_lock(&mutex_);
+	slot.state = SLOT_FREE;
+	nextToServe_++;
+	pthread_cond_broadcast(&changed_);
+	pthread_mutex_unlock(&mutex_);
+	return true;
+}
+
+
+void DecodeAheadSource::convert(IplImage *img, unsigned char *imageData){
+	if((img == NULL) || (img->width != width_) || (img->height != height_)){
+		memset(imageData, 0, frameSize_);
+	}else if(color_ != 0){
+		ImgKernels::bgrToRgb((uchar *) img->imageData, img->widthStep, img->nChannels, imageData, width_, height_);
+	}else{
+		ImgKernels::bgrToGrey((uchar *) img->imageData, img->widthStep, img->nChannels, imageData, width_, height_);
+	};
+}
+
+
+/*
+ * VideoFileSource
+ */
+VideoFileSource::VideoFileSource(const char *fileName, int color, int poolSize, bool loop)
+	: DecodeAheadSource(color, 1, poolSize){
+	fileName_ = string(fileName);
+	loop_     = loop;
+
+	// resolution of the first frame, then start again at the beginning
+	capture_ = cvCaptureFromFile(fileName);
+	IplImage *img = (capture_ != NULL) ? cvQueryFrame(capture_) : NULL;
+	if(img == NULL){
+		if(capture_ != NULL) cvReleaseCapture(&capture_);
+		throw string("Can't read video file ") + fileName_ + string("\n");
+	};
+	width_  = img->width;
+	height_ = img->height;
+	cvReleaseCapture(&capture_);
+	capture_ = cvCaptureFromFile(fileName);
+
+	start();
+}
+
+
+VideoFileSource::~VideoFileSource(){
+	stop();
+	if(capture_ != NULL) cvReleaseCapture(&capture_);
+}
+
+
+bool VideoFileSource::decode(long index, unsigned char *imageData){
+	IplImage *img = cvQueryFrame(capture_);
+	if((img == NULL) && loop_){
+		cvReleaseCapture(&capture_);
+		capture_ = cvCaptureFromFile(fileName_.c_str());
+		img = (capture_ != NULL) ? cvQueryFrame(capture_) : NULL;
+	};
+	if(img == NULL){
+		return false;
+	};
+	convert(img, imageData);
+	return true;
+}
+
+
+/*
+ * ImageDirectorySource
+ */
+static bool isImageFile(const string &name){
+	static const char *EXTENSIONS[] = {".png", ".jpg", ".jpeg", ".bmp", ".ppm", ".pgm", ".tif", ".tiff"};
+	size_t dot = name.rfind('.');
+	if(dot == string::npos) return false;
+	string ext = name.substr(dot);
+	for(size_t i = 0; i < ext.length(); i++) ext[i] = tolower(ext[i]);
+	for(size_t i = 0; i < sizeof(EXTENSIONS)/sizeof(EXTENSIONS[0]); i++){
+		if(ext == EXTENSIONS[i]) return true;
+	};
+	return false;
+}
+
+
+ImageDirectorySource::ImageDirectorySource(const char *directory, int color, int nmbThreads, int poolSize)
+	: DecodeAheadSource(color, nmbThreads, poolSize){
+	DIR *dir = opendir(directory);
+	if(dir == NULL){
+		throw string("Can't open directory ") + string(directory) + string("\n");
+	};
+	struct dirent *entry;
+	while((entry = readdir(dir)) != NULL){
+		string name(entry->d_name);
+		if(isImageFile(name)){
+			files_.push_back(string(directory) + string("/") + name);
+		};
+	};
+	closedir(dir);
+	sort(files_.begin(), files_.end());
+
+	// the first image determines the resolution
+	IplImage *img = NULL;
+	while(!files_.empty() && ((img = cvLoadImage(files_[0].c_str(), CV_LOAD_IMAGE_COLOR)) == NULL)){
+		cerr << "Can't read " << files_[0] << ", skipped.\n";
+		files_.erase(files_.begin());
+	};
+	if(img == NULL){
+		throw string("No images in directory ") + string(directory) + string("\n");
+	};
+	width_  = img->width;
+	height_ = img->height;
+	cvReleaseImage(&img);
+
+	start();
+}
+
+
+ImageDirectorySource::~ImageDirectorySource(){
+	stop();
+}
+
+
+bool ImageDirectorySource::decode(long index, unsigned char *imageData){
+	IplImage *img = cvLoadImage(files_[index % files_.size()].c_str(), CV_LOAD_IMAGE_COLOR);
+	convert(img, imageData);
+	if(img != NULL){
+		cvReleaseImage(&img);
+	};
+	return true;
+}
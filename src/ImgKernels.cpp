@@ -0,0 +1,1546 @@
+/*
+ * ImgKernels.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/ImgKernels.H"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace ImgKernels{
+
+
+/*
+ * Byte maps of the shuffle kernels.
+ *
+ * A block consists of three vectors of V bytes (V pixels of 3 bytes).
+ * Output byte j of a block is input byte source(j) of the block, the
+ * shuffle masks of every output vector and every input vector are
+ * generated from these maps once at start up.
+ */
+#define SWIZZLE_MAX_V 64
+
+struct ByteMap{
+	unsigned char      idx[3][3][SWIZZLE_MAX_V];   // [out vector][in vector][byte], 0x80: not from this vector
+	unsigned long long mask[3][3];                 // bit j set: byte j taken from this vector
+};
+
+// exchanges the first and the third byte of every pixel
+static int sourceSwap(int j, int V){
+	return j - (j % 3) + 2 - (j % 3);
+}
+
+// writes every byte of the first vector into the three bytes of a pixel
+static int sourceExpand(int j, int V){
+	return j / 3;
+}
+
+// splits the pixels into three planes, one per vector
+static int sourceSplit(int j, int V){
+	return 3 * (j % V) + (j / V);
+}
+
+static void buildMap(ByteMap *m, int V, int (*source)(int j, int V)){
+	memset(m->idx, 0x80, sizeof(m->idx));
+	memset(m->mask, 0, sizeof(m->mask));
+	for(int j = 0; j < 3*V; j++){
+		int s = source(j, V);
+		m->idx[j / V][s / V][j % V] = (unsigned char) (s % V);
+		m->mask[j / V][s / V] |= 1ULL << (j % V);
+	};
+}
+
+static ByteMap swap16_, expand16_, split16_;
+static ByteMap swap64_, expand64_, split64_;
+
+
+/*
+ * Row kernels, n pixels of packed data, 3 bytes per pixel.
+ */
+static void swapRowScalar(const unsigned char *src, unsigned char *dst, int n){
+	for(int j = 0; j < n; j++){
+		dst[3*j + 0] = src[3*j + 2];
+		dst[3*j + 1] = src[3*j + 1];
+		dst[3*j + 2] = src[3*j + 0];
+	};
+}
+
+static void expandRowScalar(const unsigned char *src, unsigned char *dst, int n){
+	for(int j = 0; j < n; j++){
+		dst[3*j + 0] = src[j];
+		dst[3*j + 1] = src[j];
+		dst[3*j + 2] = src[j];
+	};
+}
+
+// ITU-R BT.601 luma of BGR pixels, weights in 1/256
+#define LUMA_B  29
+#define LUMA_G 150
+#define LUMA_R  77
+
+static void lumaRowScalar(const unsigned char *src, unsigned char *dst, int n){
+	for(int j = 0; j < n; j++){
+		dst[j] = (unsigned char) ((LUMA_B*src[3*j] + LUMA_G*src[3*j + 1] + LUMA_R*src[3*j + 2] + 128) >> 8);
+	};
+}
+
+
+/*
+ * Color filter rows, n pixels of packed RGB data.  The filter outputs
+ * r, g, b and their sum s are optional (NULL), sum is always written.
+ *
+ * A filter passes its channel if the channel is above its threshold and
+ * the other two channels are below theirs.  The weighted sum uses
+ * 16 bit fixed point as the vector kernels do: (value << 8) * weight
+ * >> 16 is value * part / 100 with 7 fractional bits.
+ */
+#define FILTER_FRACTION_BITS 7
+
+static inline unsigned int weighted(unsigned int value, unsigned int weight){
+	return ((value << 8) * weight) >> 16;
+}
+
+// weighted sum of the filter outputs, as the vector kernels compute it;
+// they saturate the 16 bit sum at 65535, which is above
+// 255 << FILTER_FRACTION_BITS as well
+static inline unsigned int filterSum(unsigned int fR, unsigned int fG, unsigned int fB, const ColorFilterPrepared &p){
+	unsigned int v = ((weighted(fR, p.weightR) + weighted(fG, p.weightG) + weighted(fB, p.weightB))
+	                  >> FILTER_FRACTION_BITS) + p.add;
+	return (v > 255) ? 255 : v;
+}
+
+// filter outputs and their weighted sum of one RGB pixel
+static inline unsigned int filterPixel(const unsigned char *pixel, const ColorFilterPrepared &p,
+		unsigned int *fR, unsigned int *fG, unsigned int *fB){
+	unsigned int valueR = pixel[0];
+	unsigned int valueG = pixel[1];
+	unsigned int valueB = pixel[2];
+
+	// & instead of && keeps the random outcomes off the branch predictor
+	*fR = valueR & -((valueR > p.rThreshR) & (valueG < p.rThreshG) & (valueB < p.rThreshB));
+	*fG = valueG & -((valueG > p.gThreshG) & (valueR < p.gThreshR) & (valueB < p.gThreshB));
+	*fB = valueB & -((valueB > p.bThreshB) & (valueG < p.bThreshG) & (valueR < p.bThreshR));
+	return filterSum(*fR, *fG, *fB, p);
+}
+
+static void filterRowScalar(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	for(int j = 0; j < n; j++){
+		unsigned int fR, fG, fB;
+		unsigned int v = filterPixel(rgb + 3*j, p, &fR, &fG, &fB);
+
+		if(r != NULL) r[j] = (unsigned char) fR;
+		if(g != NULL) g[j] = (unsigned char) fG;
+		if(b != NULL) b[j] = (unsigned char) fB;
+		if(s != NULL) s[j] = (unsigned char) v;
+		sum[j] = (unsigned char) v;
+	};
+}
+
+static void filterLutRowScalar(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	for(int j = 0; j < n; j++){
+		unsigned int valueR = rgb[3*j];
+		unsigned int valueG = rgb[3*j + 1];
+		unsigned int valueB = rgb[3*j + 2];
+
+		unsigned int classes = p.lut.r[valueR] & p.lut.g[valueG] & p.lut.b[valueB];
+		unsigned int fR = valueR & -(classes & COLOR_CLASS_R);
+		unsigned int fG = valueG & -((classes & COLOR_CLASS_G) >> 1);
+		unsigned int fB = valueB & -((classes & COLOR_CLASS_B) >> 2);
+		unsigned int v  = filterSum(fR, fG, fB, p);
+
+		if(r != NULL) r[j] = (unsigned char) fR;
+		if(g != NULL) g[j] = (unsigned char) fG;
+		if(b != NULL) b[j] = (unsigned char) fB;
+		if(s != NULL) s[j] = (unsigned char) v;
+		sum[j] = (unsigned char) v;
+	};
+}
+
+static void classifyRowScalar(const unsigned char *rgb, int n, const ColorClassLut &lut, unsigned char *classes){
+	for(int j = 0; j < n; j++){
+		classes[j] = lut.r[rgb[3*j]] & lut.g[rgb[3*j + 1]] & lut.b[rgb[3*j + 2]];
+	};
+}
+
+static inline unsigned char *advance(unsigned char *p, int j){
+	return (p != NULL) ? p + j : NULL;
+}
+
+// pixels of a row above the threshold (value >= above)
+struct BlobRow{
+	int       first, last;    // columns, -1 if none
+	int       count;
+	long long sumX;           // sum of the columns
+};
+
+static inline void blobRowInit(BlobRow *row){
+	row->first = -1;
+	row->last  = -1;
+	row->count = 0;
+	row->sumX  = 0;
+}
+
+static inline void blobRowPixel(int j, BlobRow *row){
+	if(row->first < 0) row->first = j;
+	row->last = j;
+	row->count++;
+	row->sumX += j;
+}
+
+// continues row with the columns j .. n-1
+static inline void blobRowTail(const unsigned char *grey, int j, int n, unsigned char above, BlobRow *row){
+	for(; j < n; j++){
+		if(grey[j] >= above){
+			blobRowPixel(j, row);
+		};
+	};
+}
+
+static void blobRowScalar(const unsigned char *grey, int n, unsigned char above, BlobRow *row){
+	blobRowInit(row);
+	blobRowTail(grey, 0, n, above, row);
+}
+
+// color filter and blob row in one: the sum of a pixel of packed RGB
+// image data is compared with above instead of being stored
+static inline void filterBlobRowTail(const unsigned char *rgb, int j, int n, const ColorFilterPrepared &p,
+		unsigned char above, BlobRow *row){
+	for(; j < n; j++){
+		unsigned int fR, fG, fB;
+		if(filterPixel(rgb + 3*j, p, &fR, &fG, &fB) >= above){
+			blobRowPixel(j, row);
+		};
+	};
+}
+
+static void filterBlobRowScalar(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char above, BlobRow *row){
+	blobRowInit(row);
+	filterBlobRowTail(rgb, 0, n, p, above, row);
+}
+
+// run boundaries of a row: the columns where a pixel is above the
+// threshold (value >= above) and its left neighbour isn't or vice versa
+static inline int runsTail(const unsigned char *grey, int j, int n, unsigned char above, bool inRun,
+		int *bounds, int nmbBounds){
+	for(; j < n; j++){
+		bool pass = (grey[j] >= above);
+		if(pass != inRun){
+			bounds[nmbBounds++] = j;
+			inRun = pass;
+		};
+	};
+	if(inRun){
+		bounds[nmbBounds++] = n;
+	};
+	return nmbBounds;
+}
+
+static int runsRowScalar(const unsigned char *grey, int n, unsigned char above, int *bounds){
+	return runsTail(grey, 0, n, above, false, bounds, 0);
+}
+
+// boundaries within a vector of V pixels starting at column j, mask m
+// holding one bit per pixel; returns whether the last pixel is in a run
+static inline bool runsOfMask(uint64_t m, int V, int j, bool inRun, int *bounds, int *nmbBounds){
+	uint64_t t = m ^ ((m << 1) | (inRun ? 1 : 0));
+	if(V < 64){
+		t &= (((uint64_t) 1) << V) - 1;
+	};
+	while(t != 0){
+		bounds[(*nmbBounds)++] = j + __builtin_ctzll(t);
+		t &= t - 1;
+	};
+	return ((m >> (V - 1)) & 1) != 0;
+}
+
+// maximum of every 2x2 block of two rows, n blocks from column j on
+static inline void maxPoolTail(const unsigned char *row0, const unsigned char *row1, int j, int n,
+		unsigned char *out){
+	for(; j < n; j++){
+		unsigned char a = (row0[2*j] > row0[2*j + 1]) ? row0[2*j] : row0[2*j + 1];
+		unsigned char b = (row1[2*j] > row1[2*j + 1]) ? row1[2*j] : row1[2*j + 1];
+		out[j] = (a > b) ? a : b;
+	};
+}
+
+static void maxPoolRowScalar(const unsigned char *row0, const unsigned char *row1, int n, unsigned char *out){
+	maxPoolTail(row0, row1, 0, n, out);
+}
+
+// 0, 1, ..., 63: the column within a vector, summed up by psadbw
+static const unsigned char IOTA_[64] = {
+		 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+		16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+		32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+		48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63};
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define TARGET_SSSE3  __attribute__((target("ssse3")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vbmi")))
+
+// SSSE3, one block of 48 bytes per step, pshufb with zeroing masks
+
+TARGET_SSSE3 static inline __m128i permute16(const ByteMap &m, int k, __m128i in0, __m128i in1, __m128i in2){
+	__m128i r =          _mm_shuffle_epi8(in0, _mm_loadu_si128((const __m128i *) m.idx[k][0]));
+	r = _mm_or_si128(r,  _mm_shuffle_epi8(in1, _mm_loadu_si128((const __m128i *) m.idx[k][1])));
+	return _mm_or_si128(r, _mm_shuffle_epi8(in2, _mm_loadu_si128((const __m128i *) m.idx[k][2])));
+}
+
+TARGET_SSSE3 static inline __m128i luma16(__m128i b, __m128i g, __m128i r){
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128i wB    = _mm_set1_epi16(LUMA_B);
+	const __m128i wG    = _mm_set1_epi16(LUMA_G);
+	const __m128i wR    = _mm_set1_epi16(LUMA_R);
+	const __m128i round = _mm_set1_epi16(128);
+	__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), wB),
+	                                         _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), wG)),
+	                           _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(r, zero), wR), round));
+	__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), wB),
+	                                         _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), wG)),
+	                           _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(r, zero), wR), round));
+	return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+TARGET_SSSE3 static void swapRowSsse3(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		const __m128i *s = (const __m128i *) (src + 3*j);
+		__m128i in0 = _mm_loadu_si128(s);
+		__m128i in1 = _mm_loadu_si128(s + 1);
+		__m128i in2 = _mm_loadu_si128(s + 2);
+		__m128i *d = (__m128i *) (dst + 3*j);
+		_mm_storeu_si128(d,     permute16(swap16_, 0, in0, in1, in2));
+		_mm_storeu_si128(d + 1, permute16(swap16_, 1, in0, in1, in2));
+		_mm_storeu_si128(d + 2, permute16(swap16_, 2, in0, in1, in2));
+	};
+	swapRowScalar(src + 3*j, dst + 3*j, n - j);
+}
+
+TARGET_SSSE3 static void expandRowSsse3(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		__m128i in = _mm_loadu_si128((const __m128i *) (src + j));
+		__m128i *d = (__m128i *) (dst + 3*j);
+		_mm_storeu_si128(d,     _mm_shuffle_epi8(in, _mm_loadu_si128((const __m128i *) expand16_.idx[0][0])));
+		_mm_storeu_si128(d + 1, _mm_shuffle_epi8(in, _mm_loadu_si128((const __m128i *) expand16_.idx[1][0])));
+		_mm_storeu_si128(d + 2, _mm_shuffle_epi8(in, _mm_loadu_si128((const __m128i *) expand16_.idx[2][0])));
+	};
+	expandRowScalar(src + j, dst + 3*j, n - j);
+}
+
+TARGET_SSSE3 static void lumaRowSsse3(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		const __m128i *s = (const __m128i *) (src + 3*j);
+		__m128i in0 = _mm_loadu_si128(s);
+		__m128i in1 = _mm_loadu_si128(s + 1);
+		__m128i in2 = _mm_loadu_si128(s + 2);
+		_mm_storeu_si128((__m128i *) (dst + j), luma16(permute16(split16_, 0, in0, in1, in2),
+		                                               permute16(split16_, 1, in0, in1, in2),
+		                                               permute16(split16_, 2, in0, in1, in2)));
+	};
+	lumaRowScalar(src + 3*j, dst + j, n - j);
+}
+
+
+// value if value > above and other1 < below1 and other2 < below2, else 0;
+// a > t exactly if the saturated difference a - t is not zero
+TARGET_SSSE3 static inline __m128i pass16(__m128i value, __m128i above,
+		__m128i other1, __m128i below1, __m128i other2, __m128i below2){
+	const __m128i zero = _mm_setzero_si128();
+	__m128i fail = _mm_cmpeq_epi8(_mm_subs_epu8(value, above), zero);
+	fail = _mm_or_si128(fail, _mm_cmpeq_epi8(_mm_subs_epu8(below1, other1), zero));
+	fail = _mm_or_si128(fail, _mm_cmpeq_epi8(_mm_subs_epu8(below2, other2), zero));
+	return _mm_andnot_si128(fail, value);
+}
+
+TARGET_SSSE3 static inline __m128i filterSum16(__m128i fR, __m128i fG, __m128i fB,
+		__m128i wR, __m128i wG, __m128i wB, __m128i add){
+	// unpacking below a zero byte yields value << 8
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_adds_epu16(_mm_adds_epu16(_mm_mulhi_epu16(_mm_unpacklo_epi8(zero, fR), wR),
+	                                           _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, fG), wG)),
+	                            _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, fB), wB));
+	__m128i hi = _mm_adds_epu16(_mm_adds_epu16(_mm_mulhi_epu16(_mm_unpackhi_epi8(zero, fR), wR),
+	                                           _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, fG), wG)),
+	                            _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, fB), wB));
+	lo = _mm_adds_epu16(_mm_srli_epi16(lo, FILTER_FRACTION_BITS), add);
+	hi = _mm_adds_epu16(_mm_srli_epi16(hi, FILTER_FRACTION_BITS), add);
+	return _mm_packus_epi16(lo, hi);
+}
+
+TARGET_SSSE3 static void filterRowSsse3(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	const __m128i rThreshR = _mm_set1_epi8(p.rThreshR), rThreshG = _mm_set1_epi8(p.rThreshG), rThreshB = _mm_set1_epi8(p.rThreshB);
+	const __m128i gThreshR = _mm_set1_epi8(p.gThreshR), gThreshG = _mm_set1_epi8(p.gThreshG), gThreshB = _mm_set1_epi8(p.gThreshB);
+	const __m128i bThreshR = _mm_set1_epi8(p.bThreshR), bThreshG = _mm_set1_epi8(p.bThreshG), bThreshB = _mm_set1_epi8(p.bThreshB);
+	const __m128i wR = _mm_set1_epi16(p.weightR), wG = _mm_set1_epi16(p.weightG), wB = _mm_set1_epi16(p.weightB);
+	const __m128i add = _mm_set1_epi16(p.add);
+
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		const __m128i *src = (const __m128i *) (rgb + 3*j);
+		__m128i in0 = _mm_loadu_si128(src);
+		__m128i in1 = _mm_loadu_si128(src + 1);
+		__m128i in2 = _mm_loadu_si128(src + 2);
+		__m128i valueR = permute16(split16_, 0, in0, in1, in2);
+		__m128i valueG = permute16(split16_, 1, in0, in1, in2);
+		__m128i valueB = permute16(split16_, 2, in0, in1, in2);
+
+		__m128i fR = pass16(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m128i fG = pass16(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m128i fB = pass16(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m128i v  = filterSum16(fR, fG, fB, wR, wG, wB, add);
+
+		if(r != NULL) _mm_storeu_si128((__m128i *) (r + j), fR);
+		if(g != NULL) _mm_storeu_si128((__m128i *) (g + j), fG);
+		if(b != NULL) _mm_storeu_si128((__m128i *) (b + j), fB);
+		if(s != NULL) _mm_storeu_si128((__m128i *) (s + j), v);
+		_mm_storeu_si128((__m128i *) (sum + j), v);
+	};
+	filterRowScalar(rgb + 3*j, n - j, p, advance(r, j), advance(g, j), advance(b, j), advance(s, j), sum + j);
+}
+
+
+// compare, movemask, first and last set bit; vectors without any pixel
+// above the threshold cost the compare only
+TARGET_SSSE3 static inline void blobStep16(__m128i pass, int j, __m128i iota, __m128i *sumX, BlobRow *row){
+	unsigned int m = (unsigned int) _mm_movemask_epi8(pass);
+	if(m != 0){
+		int c = __builtin_popcount(m);
+		if(row->first < 0) row->first = j + __builtin_ctz(m);
+		row->last   = j + 31 - __builtin_clz(m);
+		row->count += c;
+		row->sumX  += (long long) j * c;
+		*sumX = _mm_add_epi64(*sumX, _mm_sad_epu8(_mm_and_si128(pass, iota), _mm_setzero_si128()));
+	};
+}
+
+TARGET_SSSE3 static inline long long blobSums16(__m128i sumX){
+	long long sums[2];
+	_mm_storeu_si128((__m128i *) sums, sumX);
+	return sums[0] + sums[1];
+}
+
+TARGET_SSSE3 static void blobRowSsse3(const unsigned char *grey, int n, unsigned char above, BlobRow *row){
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i t    = _mm_set1_epi8((char) above);
+	const __m128i iota = _mm_loadu_si128((const __m128i *) IOTA_);
+	__m128i sumX = zero;
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		__m128i v = _mm_loadu_si128((const __m128i *) (grey + j));
+		blobStep16(_mm_cmpeq_epi8(_mm_max_epu8(v, t), v), j, iota, &sumX, row);
+	};
+	row->sumX += blobSums16(sumX);
+	blobRowTail(grey, j, n, above, row);
+}
+
+
+// colorFilter() and blobRow in one pass, the sums never leave the
+// registers
+TARGET_SSSE3 static void filterBlobRowSsse3(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char above, BlobRow *row){
+	const __m128i rThreshR = _mm_set1_epi8(p.rThreshR), rThreshG = _mm_set1_epi8(p.rThreshG), rThreshB = _mm_set1_epi8(p.rThreshB);
+	const __m128i gThreshR = _mm_set1_epi8(p.gThreshR), gThreshG = _mm_set1_epi8(p.gThreshG), gThreshB = _mm_set1_epi8(p.gThreshB);
+	const __m128i bThreshR = _mm_set1_epi8(p.bThreshR), bThreshG = _mm_set1_epi8(p.bThreshG), bThreshB = _mm_set1_epi8(p.bThreshB);
+	const __m128i wR = _mm_set1_epi16(p.weightR), wG = _mm_set1_epi16(p.weightG), wB = _mm_set1_epi16(p.weightB);
+	const __m128i add  = _mm_set1_epi16(p.add);
+	const __m128i t    = _mm_set1_epi8((char) above);
+	const __m128i iota = _mm_loadu_si128((const __m128i *) IOTA_);
+	__m128i sumX = _mm_setzero_si128();
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		const __m128i *src = (const __m128i *) (rgb + 3*j);
+		__m128i in0 = _mm_loadu_si128(src);
+		__m128i in1 = _mm_loadu_si128(src + 1);
+		__m128i in2 = _mm_loadu_si128(src + 2);
+		__m128i valueR = permute16(split16_, 0, in0, in1, in2);
+		__m128i valueG = permute16(split16_, 1, in0, in1, in2);
+		__m128i valueB = permute16(split16_, 2, in0, in1, in2);
+
+		__m128i fR = pass16(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m128i fG = pass16(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m128i fB = pass16(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m128i v  = filterSum16(fR, fG, fB, wR, wG, wB, add);
+		blobStep16(_mm_cmpeq_epi8(_mm_max_epu8(v, t), v), j, iota, &sumX, row);
+	};
+	row->sumX += blobSums16(sumX);
+	filterBlobRowTail(rgb, j, n, p, above, row);
+}
+
+
+TARGET_SSSE3 static int runsRowSsse3(const unsigned char *grey, int n, unsigned char above, int *bounds){
+	const __m128i t = _mm_set1_epi8((char) above);
+	int  nmbBounds = 0;
+	bool inRun     = false;
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		__m128i v = _mm_loadu_si128((const __m128i *) (grey + j));
+		uint64_t m = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, t), v));
+		if((m != 0) || inRun){
+			inRun = runsOfMask(m, 16, j, inRun, bounds, &nmbBounds);
+		};
+	};
+	return runsTail(grey, j, n, above, inRun, bounds, nmbBounds);
+}
+
+
+// vertical max of the two rows, then the max of every byte pair in the
+// low byte of its 16 bit lane, packed to bytes
+TARGET_SSSE3 static inline __m128i maxPairs16(__m128i v){
+	return _mm_and_si128(_mm_max_epu8(v, _mm_srli_epi16(v, 8)), _mm_set1_epi16(0x00FF));
+}
+
+TARGET_SSSE3 static void maxPoolRowSsse3(const unsigned char *row0, const unsigned char *row1, int n, unsigned char *out){
+	int j = 0;
+	for(; j + 16 <= n; j += 16){
+		__m128i lo = _mm_max_epu8(_mm_loadu_si128((const __m128i *) (row0 + 2*j)),
+				_mm_loadu_si128((const __m128i *) (row1 + 2*j)));
+		__m128i hi = _mm_max_epu8(_mm_loadu_si128((const __m128i *) (row0 + 2*j + 16)),
+				_mm_loadu_si128((const __m128i *) (row1 + 2*j + 16)));
+		_mm_storeu_si128((__m128i *) (out + j), _mm_packus_epi16(maxPairs16(lo), maxPairs16(hi)));
+	};
+	maxPoolTail(row0, row1, j, n, out);
+}
+
+
+// AVX2, pshufb works within 128 bit lanes: two blocks of 48 bytes per
+// step, the low lanes hold the first block, the high lanes the second
+
+TARGET_AVX2 static inline __m256i load2x16(const unsigned char *p){
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) p)),
+	                               _mm_loadu_si128((const __m128i *) (p + 48)), 1);
+}
+
+TARGET_AVX2 static inline void store2x16(unsigned char *p, __m256i v){
+	_mm_storeu_si128((__m128i *) p,        _mm256_castsi256_si128(v));
+	_mm_storeu_si128((__m128i *) (p + 48), _mm256_extracti128_si256(v, 1));
+}
+
+TARGET_AVX2 static inline __m256i mask32(const unsigned char *idx){
+	return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) idx));
+}
+
+TARGET_AVX2 static inline __m256i permute32(const ByteMap &m, int k, __m256i in0, __m256i in1, __m256i in2){
+	__m256i r =             _mm256_shuffle_epi8(in0, mask32(m.idx[k][0]));
+	r = _mm256_or_si256(r,  _mm256_shuffle_epi8(in1, mask32(m.idx[k][1])));
+	return _mm256_or_si256(r, _mm256_shuffle_epi8(in2, mask32(m.idx[k][2])));
+}
+
+TARGET_AVX2 static inline __m256i luma32(__m256i b, __m256i g, __m256i r){
+	const __m256i zero  = _mm256_setzero_si256();
+	const __m256i wB    = _mm256_set1_epi16(LUMA_B);
+	const __m256i wG    = _mm256_set1_epi16(LUMA_G);
+	const __m256i wR    = _mm256_set1_epi16(LUMA_R);
+	const __m256i round = _mm256_set1_epi16(128);
+	__m256i lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), wB),
+	                                               _mm256_mullo_epi16(_mm256_unpacklo_epi8(g, zero), wG)),
+	                              _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(r, zero), wR), round));
+	__m256i hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), wB),
+	                                               _mm256_mullo_epi16(_mm256_unpackhi_epi8(g, zero), wG)),
+	                              _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(r, zero), wR), round));
+	return _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+}
+
+TARGET_AVX2 static void swapRowAvx2(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		const unsigned char *s = src + 3*j;
+		__m256i in0 = load2x16(s);
+		__m256i in1 = load2x16(s + 16);
+		__m256i in2 = load2x16(s + 32);
+		unsigned char *d = dst + 3*j;
+		store2x16(d,      permute32(swap16_, 0, in0, in1, in2));
+		store2x16(d + 16, permute32(swap16_, 1, in0, in1, in2));
+		store2x16(d + 32, permute32(swap16_, 2, in0, in1, in2));
+	};
+	swapRowSsse3(src + 3*j, dst + 3*j, n - j);
+}
+
+TARGET_AVX2 static void expandRowAvx2(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		// 16 grey bytes per lane
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (src + j))),
+		                                     _mm_loadu_si128((const __m128i *) (src + j + 16)), 1);
+		unsigned char *d = dst + 3*j;
+		store2x16(d,      _mm256_shuffle_epi8(in, mask32(expand16_.idx[0][0])));
+		store2x16(d + 16, _mm256_shuffle_epi8(in, mask32(expand16_.idx[1][0])));
+		store2x16(d + 32, _mm256_shuffle_epi8(in, mask32(expand16_.idx[2][0])));
+	};
+	expandRowSsse3(src + j, dst + 3*j, n - j);
+}
+
+TARGET_AVX2 static void lumaRowAvx2(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		const unsigned char *s = src + 3*j;
+		__m256i in0 = load2x16(s);
+		__m256i in1 = load2x16(s + 16);
+		__m256i in2 = load2x16(s + 32);
+		__m256i y = luma32(permute32(split16_, 0, in0, in1, in2),
+		                   permute32(split16_, 1, in0, in1, in2),
+		                   permute32(split16_, 2, in0, in1, in2));
+		_mm_storeu_si128((__m128i *) (dst + j),      _mm256_castsi256_si128(y));
+		_mm_storeu_si128((__m128i *) (dst + j + 16), _mm256_extracti128_si256(y, 1));
+	};
+	lumaRowSsse3(src + 3*j, dst + j, n - j);
+}
+
+
+TARGET_AVX2 static inline __m256i pass32(__m256i value, __m256i above,
+		__m256i other1, __m256i below1, __m256i other2, __m256i below2){
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i fail = _mm256_cmpeq_epi8(_mm256_subs_epu8(value, above), zero);
+	fail = _mm256_or_si256(fail, _mm256_cmpeq_epi8(_mm256_subs_epu8(below1, other1), zero));
+	fail = _mm256_or_si256(fail, _mm256_cmpeq_epi8(_mm256_subs_epu8(below2, other2), zero));
+	return _mm256_andnot_si256(fail, value);
+}
+
+TARGET_AVX2 static inline __m256i filterSum32(__m256i fR, __m256i fG, __m256i fB,
+		__m256i wR, __m256i wG, __m256i wB, __m256i add){
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i lo = _mm256_adds_epu16(_mm256_adds_epu16(_mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, fR), wR),
+	                                                 _mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, fG), wG)),
+	                               _mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, fB), wB));
+	__m256i hi = _mm256_adds_epu16(_mm256_adds_epu16(_mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, fR), wR),
+	                                                 _mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, fG), wG)),
+	                               _mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, fB), wB));
+	lo = _mm256_adds_epu16(_mm256_srli_epi16(lo, FILTER_FRACTION_BITS), add);
+	hi = _mm256_adds_epu16(_mm256_srli_epi16(hi, FILTER_FRACTION_BITS), add);
+	return _mm256_packus_epi16(lo, hi);
+}
+
+TARGET_AVX2 static void filterRowAvx2(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	const __m256i rThreshR = _mm256_set1_epi8(p.rThreshR), rThreshG = _mm256_set1_epi8(p.rThreshG), rThreshB = _mm256_set1_epi8(p.rThreshB);
+	const __m256i gThreshR = _mm256_set1_epi8(p.gThreshR), gThreshG = _mm256_set1_epi8(p.gThreshG), gThreshB = _mm256_set1_epi8(p.gThreshB);
+	const __m256i bThreshR = _mm256_set1_epi8(p.bThreshR), bThreshG = _mm256_set1_epi8(p.bThreshG), bThreshB = _mm256_set1_epi8(p.bThreshB);
+	const __m256i wR = _mm256_set1_epi16(p.weightR), wG = _mm256_set1_epi16(p.weightG), wB = _mm256_set1_epi16(p.weightB);
+	const __m256i add = _mm256_set1_epi16(p.add);
+
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		// the low lanes hold pixels j..j+15, the high lanes j+16..j+31,
+		// the planes come out in pixel order
+		const unsigned char *src = rgb + 3*j;
+		__m256i in0 = load2x16(src);
+		__m256i in1 = load2x16(src + 16);
+		__m256i in2 = load2x16(src + 32);
+		__m256i valueR = permute32(split16_, 0, in0, in1, in2);
+		__m256i valueG = permute32(split16_, 1, in0, in1, in2);
+		__m256i valueB = permute32(split16_, 2, in0, in1, in2);
+
+		__m256i fR = pass32(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m256i fG = pass32(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m256i fB = pass32(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m256i v  = filterSum32(fR, fG, fB, wR, wG, wB, add);
+
+		if(r != NULL) _mm256_storeu_si256((__m256i *) (r + j), fR);
+		if(g != NULL) _mm256_storeu_si256((__m256i *) (g + j), fG);
+		if(b != NULL) _mm256_storeu_si256((__m256i *) (b + j), fB);
+		if(s != NULL) _mm256_storeu_si256((__m256i *) (s + j), v);
+		_mm256_storeu_si256((__m256i *) (sum + j), v);
+	};
+	filterRowSsse3(rgb + 3*j, n - j, p, advance(r, j), advance(g, j), advance(b, j), advance(s, j), sum + j);
+}
+
+
+TARGET_AVX2 static inline void blobStep32(__m256i pass, int j, __m256i iota, __m256i *sumX, BlobRow *row){
+	unsigned int m = (unsigned int) _mm256_movemask_epi8(pass);
+	if(m != 0){
+		int c = __builtin_popcount(m);
+		if(row->first < 0) row->first = j + __builtin_ctz(m);
+		row->last   = j + 31 - __builtin_clz(m);
+		row->count += c;
+		row->sumX  += (long long) j * c;
+		*sumX = _mm256_add_epi64(*sumX, _mm256_sad_epu8(_mm256_and_si256(pass, iota), _mm256_setzero_si256()));
+	};
+}
+
+TARGET_AVX2 static inline long long blobSums32(__m256i sumX){
+	long long sums[4];
+	_mm256_storeu_si256((__m256i *) sums, sumX);
+	return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+TARGET_AVX2 static void blobRowAvx2(const unsigned char *grey, int n, unsigned char above, BlobRow *row){
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i t    = _mm256_set1_epi8((char) above);
+	const __m256i iota = _mm256_loadu_si256((const __m256i *) IOTA_);
+	__m256i sumX = zero;
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i *) (grey + j));
+		blobStep32(_mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v), j, iota, &sumX, row);
+	};
+	row->sumX += blobSums32(sumX);
+	blobRowTail(grey, j, n, above, row);
+}
+
+
+TARGET_AVX2 static void filterBlobRowAvx2(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char above, BlobRow *row){
+	const __m256i rThreshR = _mm256_set1_epi8(p.rThreshR), rThreshG = _mm256_set1_epi8(p.rThreshG), rThreshB = _mm256_set1_epi8(p.rThreshB);
+	const __m256i gThreshR = _mm256_set1_epi8(p.gThreshR), gThreshG = _mm256_set1_epi8(p.gThreshG), gThreshB = _mm256_set1_epi8(p.gThreshB);
+	const __m256i bThreshR = _mm256_set1_epi8(p.bThreshR), bThreshG = _mm256_set1_epi8(p.bThreshG), bThreshB = _mm256_set1_epi8(p.bThreshB);
+	const __m256i wR = _mm256_set1_epi16(p.weightR), wG = _mm256_set1_epi16(p.weightG), wB = _mm256_set1_epi16(p.weightB);
+	const __m256i add  = _mm256_set1_epi16(p.add);
+	const __m256i t    = _mm256_set1_epi8((char) above);
+	const __m256i iota = _mm256_loadu_si256((const __m256i *) IOTA_);
+	__m256i sumX = _mm256_setzero_si256();
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		const unsigned char *src = rgb + 3*j;
+		__m256i in0 = load2x16(src);
+		__m256i in1 = load2x16(src + 16);
+		__m256i in2 = load2x16(src + 32);
+		__m256i valueR = permute32(split16_, 0, in0, in1, in2);
+		__m256i valueG = permute32(split16_, 1, in0, in1, in2);
+		__m256i valueB = permute32(split16_, 2, in0, in1, in2);
+
+		__m256i fR = pass32(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m256i fG = pass32(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m256i fB = pass32(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m256i v  = filterSum32(fR, fG, fB, wR, wG, wB, add);
+		blobStep32(_mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v), j, iota, &sumX, row);
+	};
+	row->sumX += blobSums32(sumX);
+	filterBlobRowTail(rgb, j, n, p, above, row);
+}
+
+
+TARGET_AVX2 static int runsRowAvx2(const unsigned char *grey, int n, unsigned char above, int *bounds){
+	const __m256i t = _mm256_set1_epi8((char) above);
+	int  nmbBounds = 0;
+	bool inRun     = false;
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i *) (grey + j));
+		uint64_t m = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v));
+		if((m != 0) || inRun){
+			inRun = runsOfMask(m, 32, j, inRun, bounds, &nmbBounds);
+		};
+	};
+	return runsTail(grey, j, n, above, inRun, bounds, nmbBounds);
+}
+
+
+TARGET_AVX2 static inline __m256i maxPairs32(__m256i v){
+	return _mm256_and_si256(_mm256_max_epu8(v, _mm256_srli_epi16(v, 8)), _mm256_set1_epi16(0x00FF));
+}
+
+TARGET_AVX2 static void maxPoolRowAvx2(const unsigned char *row0, const unsigned char *row1, int n, unsigned char *out){
+	int j = 0;
+	for(; j + 32 <= n; j += 32){
+		__m256i lo = _mm256_max_epu8(_mm256_loadu_si256((const __m256i *) (row0 + 2*j)),
+				_mm256_loadu_si256((const __m256i *) (row1 + 2*j)));
+		__m256i hi = _mm256_max_epu8(_mm256_loadu_si256((const __m256i *) (row0 + 2*j + 32)),
+				_mm256_loadu_si256((const __m256i *) (row1 + 2*j + 32)));
+		// packus works per lane: lo0 hi0 lo1 hi1 -> lo0 lo1 hi0 hi1
+		__m256i p = _mm256_packus_epi16(maxPairs32(lo), maxPairs32(hi));
+		_mm256_storeu_si256((__m256i *) (out + j), _mm256_permute4x64_epi64(p, _MM_SHUFFLE(3, 1, 2, 0)));
+	};
+	maxPoolTail(row0, row1, j, n, out);
+}
+
+
+// AVX-512 VBMI, vpermb across the whole register: one block of 192 bytes
+// per step, every output vector is merged from the three input vectors
+
+TARGET_AVX512 static inline __m512i permute64(const ByteMap &m, int k, __m512i in0, __m512i in1, __m512i in2){
+	__m512i r = _mm512_maskz_permutexvar_epi8(m.mask[k][0], _mm512_loadu_si512(m.idx[k][0]), in0);
+	r = _mm512_mask_permutexvar_epi8(r, m.mask[k][1], _mm512_loadu_si512(m.idx[k][1]), in1);
+	return _mm512_mask_permutexvar_epi8(r, m.mask[k][2], _mm512_loadu_si512(m.idx[k][2]), in2);
+}
+
+TARGET_AVX512 static inline __m512i luma64(__m512i b, __m512i g, __m512i r){
+	const __m512i zero  = _mm512_setzero_si512();
+	const __m512i wB    = _mm512_set1_epi16(LUMA_B);
+	const __m512i wG    = _mm512_set1_epi16(LUMA_G);
+	const __m512i wR    = _mm512_set1_epi16(LUMA_R);
+	const __m512i round = _mm512_set1_epi16(128);
+	__m512i lo = _mm512_add_epi16(_mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpacklo_epi8(b, zero), wB),
+	                                               _mm512_mullo_epi16(_mm512_unpacklo_epi8(g, zero), wG)),
+	                              _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpacklo_epi8(r, zero), wR), round));
+	__m512i hi = _mm512_add_epi16(_mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpackhi_epi8(b, zero), wB),
+	                                               _mm512_mullo_epi16(_mm512_unpackhi_epi8(g, zero), wG)),
+	                              _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpackhi_epi8(r, zero), wR), round));
+	return _mm512_packus_epi16(_mm512_srli_epi16(lo, 8), _mm512_srli_epi16(hi, 8));
+}
+
+TARGET_AVX512 static void swapRowAvx512(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *s = src + 3*j;
+		__m512i in0 = _mm512_loadu_si512(s);
+		__m512i in1 = _mm512_loadu_si512(s + 64);
+		__m512i in2 = _mm512_loadu_si512(s + 128);
+		unsigned char *d = dst + 3*j;
+		_mm512_storeu_si512(d,       permute64(swap64_, 0, in0, in1, in2));
+		_mm512_storeu_si512(d + 64,  permute64(swap64_, 1, in0, in1, in2));
+		_mm512_storeu_si512(d + 128, permute64(swap64_, 2, in0, in1, in2));
+	};
+	swapRowAvx2(src + 3*j, dst + 3*j, n - j);
+}
+
+TARGET_AVX512 static void expandRowAvx512(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		__m512i in = _mm512_loadu_si512(src + j);
+		unsigned char *d = dst + 3*j;
+		_mm512_storeu_si512(d,       _mm512_permutexvar_epi8(_mm512_loadu_si512(expand64_.idx[0][0]), in));
+		_mm512_storeu_si512(d + 64,  _mm512_permutexvar_epi8(_mm512_loadu_si512(expand64_.idx[1][0]), in));
+		_mm512_storeu_si512(d + 128, _mm512_permutexvar_epi8(_mm512_loadu_si512(expand64_.idx[2][0]), in));
+	};
+	expandRowAvx2(src + j, dst + 3*j, n - j);
+}
+
+TARGET_AVX512 static void lumaRowAvx512(const unsigned char *src, unsigned char *dst, int n){
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *s = src + 3*j;
+		__m512i in0 = _mm512_loadu_si512(s);
+		__m512i in1 = _mm512_loadu_si512(s + 64);
+		__m512i in2 = _mm512_loadu_si512(s + 128);
+		_mm512_storeu_si512(dst + j, luma64(permute64(split64_, 0, in0, in1, in2),
+		                                    permute64(split64_, 1, in0, in1, in2),
+		                                    permute64(split64_, 2, in0, in1, in2)));
+	};
+	lumaRowAvx2(src + 3*j, dst + j, n - j);
+}
+
+
+TARGET_AVX512 static inline __m512i pass64(__m512i value, __m512i above,
+		__m512i other1, __m512i below1, __m512i other2, __m512i below2){
+	__mmask64 k = _mm512_test_epi8_mask(_mm512_subs_epu8(value, above), _mm512_subs_epu8(value, above));
+	k &= _mm512_test_epi8_mask(_mm512_subs_epu8(below1, other1), _mm512_subs_epu8(below1, other1));
+	k &= _mm512_test_epi8_mask(_mm512_subs_epu8(below2, other2), _mm512_subs_epu8(below2, other2));
+	return _mm512_maskz_mov_epi8(k, value);
+}
+
+TARGET_AVX512 static inline __m512i filterSum64(__m512i fR, __m512i fG, __m512i fB,
+		__m512i wR, __m512i wG, __m512i wB, __m512i add){
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i lo = _mm512_adds_epu16(_mm512_adds_epu16(_mm512_mulhi_epu16(_mm512_unpacklo_epi8(zero, fR), wR),
+	                                                 _mm512_mulhi_epu16(_mm512_unpacklo_epi8(zero, fG), wG)),
+	                               _mm512_mulhi_epu16(_mm512_unpacklo_epi8(zero, fB), wB));
+	__m512i hi = _mm512_adds_epu16(_mm512_adds_epu16(_mm512_mulhi_epu16(_mm512_unpackhi_epi8(zero, fR), wR),
+	                                                 _mm512_mulhi_epu16(_mm512_unpackhi_epi8(zero, fG), wG)),
+	                               _mm512_mulhi_epu16(_mm512_unpackhi_epi8(zero, fB), wB));
+	lo = _mm512_adds_epu16(_mm512_srli_epi16(lo, FILTER_FRACTION_BITS), add);
+	hi = _mm512_adds_epu16(_mm512_srli_epi16(hi, FILTER_FRACTION_BITS), add);
+	return _mm512_packus_epi16(lo, hi);
+}
+
+TARGET_AVX512 static void filterRowAvx512(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	const __m512i rThreshR = _mm512_set1_epi8(p.rThreshR), rThreshG = _mm512_set1_epi8(p.rThreshG), rThreshB = _mm512_set1_epi8(p.rThreshB);
+	const __m512i gThreshR = _mm512_set1_epi8(p.gThreshR), gThreshG = _mm512_set1_epi8(p.gThreshG), gThreshB = _mm512_set1_epi8(p.gThreshB);
+	const __m512i bThreshR = _mm512_set1_epi8(p.bThreshR), bThreshG = _mm512_set1_epi8(p.bThreshG), bThreshB = _mm512_set1_epi8(p.bThreshB);
+	const __m512i wR = _mm512_set1_epi16(p.weightR), wG = _mm512_set1_epi16(p.weightG), wB = _mm512_set1_epi16(p.weightB);
+	const __m512i add = _mm512_set1_epi16(p.add);
+
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *src = rgb + 3*j;
+		__m512i in0 = _mm512_loadu_si512(src);
+		__m512i in1 = _mm512_loadu_si512(src + 64);
+		__m512i in2 = _mm512_loadu_si512(src + 128);
+		__m512i valueR = permute64(split64_, 0, in0, in1, in2);
+		__m512i valueG = permute64(split64_, 1, in0, in1, in2);
+		__m512i valueB = permute64(split64_, 2, in0, in1, in2);
+
+		__m512i fR = pass64(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m512i fG = pass64(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m512i fB = pass64(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m512i v  = filterSum64(fR, fG, fB, wR, wG, wB, add);
+
+		if(r != NULL) _mm512_storeu_si512(r + j, fR);
+		if(g != NULL) _mm512_storeu_si512(g + j, fG);
+		if(b != NULL) _mm512_storeu_si512(b + j, fB);
+		if(s != NULL) _mm512_storeu_si512(s + j, v);
+		_mm512_storeu_si512(sum + j, v);
+	};
+	filterRowAvx2(rgb + 3*j, n - j, p, advance(r, j), advance(g, j), advance(b, j), advance(s, j), sum + j);
+}
+
+
+// 256 entry table lookup: vpermi2b looks up 128 entries, bit 7 of the
+// index selects the lower or the upper half of the table
+struct Lut64{
+	__m512i q[4];
+};
+
+TARGET_AVX512 static inline void loadLut64(const unsigned char *table, Lut64 *t){
+	for(int k = 0; k < 4; k++){
+		t->q[k] = _mm512_loadu_si512(table + 64*k);
+	};
+}
+
+TARGET_AVX512 static inline __m512i lookup64(const Lut64 &t, __m512i index){
+	__m512i lo = _mm512_permutex2var_epi8(t.q[0], index, t.q[1]);
+	__m512i hi = _mm512_permutex2var_epi8(t.q[2], index, t.q[3]);
+	return _mm512_mask_blend_epi8(_mm512_movepi8_mask(index), lo, hi);
+}
+
+TARGET_AVX512 static void filterLutRowAvx512(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum){
+	Lut64 lutR, lutG, lutB;
+	loadLut64(p.lut.r, &lutR);
+	loadLut64(p.lut.g, &lutG);
+	loadLut64(p.lut.b, &lutB);
+	const __m512i classR = _mm512_set1_epi8(COLOR_CLASS_R);
+	const __m512i classG = _mm512_set1_epi8(COLOR_CLASS_G);
+	const __m512i classB = _mm512_set1_epi8(COLOR_CLASS_B);
+	const __m512i wR = _mm512_set1_epi16(p.weightR), wG = _mm512_set1_epi16(p.weightG), wB = _mm512_set1_epi16(p.weightB);
+	const __m512i add = _mm512_set1_epi16(p.add);
+
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *src = rgb + 3*j;
+		__m512i in0 = _mm512_loadu_si512(src);
+		__m512i in1 = _mm512_loadu_si512(src + 64);
+		__m512i in2 = _mm512_loadu_si512(src + 128);
+		__m512i valueR = permute64(split64_, 0, in0, in1, in2);
+		__m512i valueG = permute64(split64_, 1, in0, in1, in2);
+		__m512i valueB = permute64(split64_, 2, in0, in1, in2);
+
+		__m512i classes = _mm512_and_si512(_mm512_and_si512(lookup64(lutR, valueR), lookup64(lutG, valueG)),
+		                                   lookup64(lutB, valueB));
+		__m512i fR = _mm512_maskz_mov_epi8(_mm512_test_epi8_mask(classes, classR), valueR);
+		__m512i fG = _mm512_maskz_mov_epi8(_mm512_test_epi8_mask(classes, classG), valueG);
+		__m512i fB = _mm512_maskz_mov_epi8(_mm512_test_epi8_mask(classes, classB), valueB);
+		__m512i v  = filterSum64(fR, fG, fB, wR, wG, wB, add);
+
+		if(r != NULL) _mm512_storeu_si512(r + j, fR);
+		if(g != NULL) _mm512_storeu_si512(g + j, fG);
+		if(b != NULL) _mm512_storeu_si512(b + j, fB);
+		if(s != NULL) _mm512_storeu_si512(s + j, v);
+		_mm512_storeu_si512(sum + j, v);
+	};
+	filterLutRowScalar(rgb + 3*j, n - j, p, advance(r, j), advance(g, j), advance(b, j), advance(s, j), sum + j);
+}
+
+TARGET_AVX512 static void classifyRowAvx512(const unsigned char *rgb, int n, const ColorClassLut &lut, unsigned char *classes){
+	Lut64 lutR, lutG, lutB;
+	loadLut64(lut.r, &lutR);
+	loadLut64(lut.g, &lutG);
+	loadLut64(lut.b, &lutB);
+
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *src = rgb + 3*j;
+		__m512i in0 = _mm512_loadu_si512(src);
+		__m512i in1 = _mm512_loadu_si512(src + 64);
+		__m512i in2 = _mm512_loadu_si512(src + 128);
+		__m512i c = _mm512_and_si512(lookup64(lutR, permute64(split64_, 0, in0, in1, in2)),
+		                             lookup64(lutG, permute64(split64_, 1, in0, in1, in2)));
+		_mm512_storeu_si512(classes + j, _mm512_and_si512(c, lookup64(lutB, permute64(split64_, 2, in0, in1, in2))));
+	};
+	classifyRowScalar(rgb + 3*j, n - j, lut, classes + j);
+}
+
+TARGET_AVX512 static inline void blobStep64(__mmask64 m, int j, __m512i iota, __m512i *sumX, BlobRow *row){
+	if(m != 0){
+		int c = __builtin_popcountll(m);
+		if(row->first < 0) row->first = j + __builtin_ctzll(m);
+		row->last   = j + 63 - __builtin_clzll(m);
+		row->count += c;
+		row->sumX  += (long long) j * c;
+		*sumX = _mm512_add_epi64(*sumX, _mm512_sad_epu8(_mm512_maskz_mov_epi8(m, iota), _mm512_setzero_si512()));
+	};
+}
+
+TARGET_AVX512 static void blobRowAvx512(const unsigned char *grey, int n, unsigned char above, BlobRow *row){
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i t    = _mm512_set1_epi8((char) above);
+	const __m512i iota = _mm512_loadu_si512(IOTA_);
+	__m512i sumX = zero;
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		blobStep64(_mm512_cmpge_epu8_mask(_mm512_loadu_si512(grey + j), t), j, iota, &sumX, row);
+	};
+	row->sumX += _mm512_reduce_add_epi64(sumX);
+	blobRowTail(grey, j, n, above, row);
+}
+
+TARGET_AVX512 static void filterBlobRowAvx512(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+		unsigned char above, BlobRow *row){
+	const __m512i rThreshR = _mm512_set1_epi8(p.rThreshR), rThreshG = _mm512_set1_epi8(p.rThreshG), rThreshB = _mm512_set1_epi8(p.rThreshB);
+	const __m512i gThreshR = _mm512_set1_epi8(p.gThreshR), gThreshG = _mm512_set1_epi8(p.gThreshG), gThreshB = _mm512_set1_epi8(p.gThreshB);
+	const __m512i bThreshR = _mm512_set1_epi8(p.bThreshR), bThreshG = _mm512_set1_epi8(p.bThreshG), bThreshB = _mm512_set1_epi8(p.bThreshB);
+	const __m512i wR = _mm512_set1_epi16(p.weightR), wG = _mm512_set1_epi16(p.weightG), wB = _mm512_set1_epi16(p.weightB);
+	const __m512i add  = _mm512_set1_epi16(p.add);
+	const __m512i t    = _mm512_set1_epi8((char) above);
+	const __m512i iota = _mm512_loadu_si512(IOTA_);
+	__m512i sumX = _mm512_setzero_si512();
+
+	blobRowInit(row);
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		const unsigned char *src = rgb + 3*j;
+		__m512i in0 = _mm512_loadu_si512(src);
+		__m512i in1 = _mm512_loadu_si512(src + 64);
+		__m512i in2 = _mm512_loadu_si512(src + 128);
+		__m512i valueR = permute64(split64_, 0, in0, in1, in2);
+		__m512i valueG = permute64(split64_, 1, in0, in1, in2);
+		__m512i valueB = permute64(split64_, 2, in0, in1, in2);
+
+		__m512i fR = pass64(valueR, rThreshR, valueG, rThreshG, valueB, rThreshB);
+		__m512i fG = pass64(valueG, gThreshG, valueR, gThreshR, valueB, gThreshB);
+		__m512i fB = pass64(valueB, bThreshB, valueG, bThreshG, valueR, bThreshR);
+		__m512i v  = filterSum64(fR, fG, fB, wR, wG, wB, add);
+		blobStep64(_mm512_cmpge_epu8_mask(v, t), j, iota, &sumX, row);
+	};
+	row->sumX += _mm512_reduce_add_epi64(sumX);
+	filterBlobRowTail(rgb, j, n, p, above, row);
+}
+
+TARGET_AVX512 static int runsRowAvx512(const unsigned char *grey, int n, unsigned char above, int *bounds){
+	const __m512i t = _mm512_set1_epi8((char) above);
+	int  nmbBounds = 0;
+	bool inRun     = false;
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		uint64_t m = _mm512_cmpge_epu8_mask(_mm512_loadu_si512(grey + j), t);
+		if((m != 0) || inRun){
+			inRun = runsOfMask(m, 64, j, inRun, bounds, &nmbBounds);
+		};
+	};
+	return runsTail(grey, j, n, above, inRun, bounds, nmbBounds);
+}
+
+TARGET_AVX512 static inline __m512i maxPairs64(__m512i v){
+	return _mm512_and_si512(_mm512_max_epu8(v, _mm512_srli_epi16(v, 8)), _mm512_set1_epi16(0x00FF));
+}
+
+TARGET_AVX512 static void maxPoolRowAvx512(const unsigned char *row0, const unsigned char *row1, int n, unsigned char *out){
+	// packus works per 128 bit lane, the quad words are put in order again
+	const __m512i order = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+	int j = 0;
+	for(; j + 64 <= n; j += 64){
+		__m512i lo = _mm512_max_epu8(_mm512_loadu_si512(row0 + 2*j), _mm512_loadu_si512(row1 + 2*j));
+		__m512i hi = _mm512_max_epu8(_mm512_loadu_si512(row0 + 2*j + 64), _mm512_loadu_si512(row1 + 2*j + 64));
+		__m512i p = _mm512_packus_epi16(maxPairs64(lo), maxPairs64(hi));
+		_mm512_storeu_si512(out + j, _mm512_permutexvar_epi64(order, p));
+	};
+	maxPoolTail(row0, row1, j, n, out);
+}
+
+#endif
+
+
+/*
+ * Variant selection
+ */
+struct RowKernels{
+	void (*swap)  (const unsigned char *src, unsigned char *dst, int n);
+	void (*expand)(const unsigned char *src, unsigned char *dst, int n);
+	void (*luma)  (const unsigned char *src, unsigned char *dst, int n);
+	void (*filter)(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+			unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum);
+	void (*filterLut)(const unsigned char *rgb, int n, const ColorFilterPrepared &p,
+			unsigned char *r, unsigned char *g, unsigned char *b, unsigned char *s, unsigned char *sum);
+	void (*classify)(const unsigned char *rgb, int n, const ColorClassLut &lut, unsigned char *classes);
+	void (*blob)(const unsigned char *grey, int n, unsigned char above, BlobRow *row);
+	int  (*runs)(const unsigned char *grey, int n, unsigned char above, int *bounds);
+	void (*maxPool)(const unsigned char *row0, const unsigned char *row1, int n, unsigned char *out);
+	void (*filterBlob)(const unsigned char *rgb, int n, const ColorFilterPrepared &p, unsigned char above, BlobRow *row);
+};
+
+static const RowKernels ROW_KERNELS_[NMB_VARIANTS] = {
+		{swapRowScalar, expandRowScalar, lumaRowScalar, filterRowScalar, filterLutRowScalar, classifyRowScalar, blobRowScalar, runsRowScalar, maxPoolRowScalar, filterBlobRowScalar},
+#if defined(__x86_64__) || defined(__i386__)
+		{swapRowSsse3,  expandRowSsse3,  lumaRowSsse3,  filterRowSsse3,  filterLutRowScalar, classifyRowScalar, blobRowSsse3,  runsRowSsse3,  maxPoolRowSsse3, filterBlobRowSsse3},
+		{swapRowAvx2,   expandRowAvx2,   lumaRowAvx2,   filterRowAvx2,   filterLutRowScalar, classifyRowScalar, blobRowAvx2,   runsRowAvx2,   maxPoolRowAvx2, filterBlobRowAvx2},
+		{swapRowAvx512, expandRowAvx512, lumaRowAvx512, filterRowAvx512, filterLutRowAvx512, classifyRowAvx512, blobRowAvx512, runsRowAvx512, maxPoolRowAvx512, filterBlobRowAvx512}
+#else
+		{swapRowScalar, expandRowScalar, lumaRowScalar, filterRowScalar, filterLutRowScalar, classifyRowScalar, blobRowScalar, runsRowScalar, maxPoolRowScalar, filterBlobRowScalar},
+		{swapRowScalar, expandRowScalar, lumaRowScalar, filterRowScalar, filterLutRowScalar, classifyRowScalar, blobRowScalar, runsRowScalar, maxPoolRowScalar, filterBlobRowScalar},
+		{swapRowScalar, expandRowScalar, lumaRowScalar, filterRowScalar, filterLutRowScalar, classifyRowScalar, blobRowScalar, runsRowScalar, maxPoolRowScalar, filterBlobRowScalar}
+#endif
+};
+
+static const char *VARIANT_NAMES_[NMB_VARIANTS] = {"scalar", "ssse3", "avx2", "avx512"};
+
+
+static int initVariants(){
+	buildMap(&swap16_,   16, sourceSwap);
+	buildMap(&expand16_, 16, sourceExpand);
+	buildMap(&split16_,  16, sourceSplit);
+	buildMap(&swap64_,   64, sourceSwap);
+	buildMap(&expand64_, 64, sourceExpand);
+	buildMap(&split64_,  64, sourceSplit);
+	return bestVariant();
+}
+
+static int variant_ = initVariants();
+static const RowKernels *rows_ = &ROW_KERNELS_[variant_];
+
+
+int bestVariant(){
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512bw")) return VARIANT_AVX512;
+	if(__builtin_cpu_supports("avx2"))  return VARIANT_AVX2;
+	if(__builtin_cpu_supports("ssse3")) return VARIANT_SSSE3;
+#endif
+	return VARIANT_SCALAR;
+}
+
+
+int useVariant(int variant){
+	int best = bestVariant();
+	if((variant < VARIANT_SCALAR) || (variant > best)){
+		variant = best;
+	};
+	variant_ = variant;
+	rows_    = &ROW_KERNELS_[variant];
+	return variant;
+}
+
+
+int currentVariant(){
+	return variant_;
+}
+
+
+const char *variantName(int variant){
+	if((variant < 0) || (variant >= NMB_VARIANTS)) return "unknown";
+	return VARIANT_NAMES_[variant];
+}
+
+
+void bgrToRgb(const unsigned char *src, int srcStep, int srcChannels,
+		unsigned char *dst, int width, int height){
+	if(srcChannels == 3){
+		if(srcStep == 3*width){
+			rows_->swap(src, dst, width*height);
+		}else{
+			for(int i = 0; i < height; i++){
+				rows_->swap(src + i*srcStep, dst + 3*width*i, width);
+			};
+		};
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		for(int j = 0; j < width; j++){
+			dst[3*((width*i) + j) + 2] = (src + i*srcStep)[j*srcChannels + 0]; // B
+			dst[3*((width*i) + j) + 1] = (src + i*srcStep)[j*srcChannels + 1]; // G
+			dst[3*((width*i) + j) + 0] = (src + i*srcStep)[j*srcChannels + 2]; // R
+		};
+	};
+}
+
+
+void rgbToBgr(const unsigned char *src,
+		unsigned char *dst, int dstStep, int dstChannels, int width, int height){
+	if(dstChannels == 3){
+		if(dstStep == 3*width){
+			rows_->swap(src, dst, width*height);
+		}else{
+			for(int i = 0; i < height; i++){
+				rows_->swap(src + 3*width*i, dst + i*dstStep, width);
+			};
+		};
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		for(int j = 0; j < width; j++){
+			(dst + i*dstStep)[j*dstChannels + 0] = src[3*((width*i) + j) + 2]; // B
+			(dst + i*dstStep)[j*dstChannels + 1] = src[3*((width*i) + j) + 1]; // G
+			(dst + i*dstStep)[j*dstChannels + 2] = src[3*((width*i) + j) + 0]; // R
+		};
+	};
+}
+
+
+void greyToPlane(const unsigned char *src,
+		unsigned char *dst, int dstStep, int width, int height){
+	for(int i = 0; i < height; i++){
+		memcpy(dst + i*dstStep, src + width*i, width);
+	};
+}
+
+
+void greyToBgr(const unsigned char *src,
+		unsigned char *dst, int dstStep, int dstChannels, int width, int height){
+	if(dstChannels == 3){
+		if(dstStep == 3*width){
+			rows_->expand(src, dst, width*height);
+		}else{
+			for(int i = 0; i < height; i++){
+				rows_->expand(src + width*i, dst + i*dstStep, width);
+			};
+		};
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		for(int j = 0; j < width; j++){
+			(dst + i*dstStep)[j*dstChannels + 0] = src[(width*i) + j]; // B
+			(dst + i*dstStep)[j*dstChannels + 1] = src[(width*i) + j]; // G
+			(dst + i*dstStep)[j*dstChannels + 2] = src[(width*i) + j]; // R
+		};
+	};
+}
+
+
+void bgrToGrey(const unsigned char *src, int srcStep, int srcChannels,
+		unsigned char *dst, int width, int height){
+	if(srcChannels == 3){
+		if(srcStep == 3*width){
+			rows_->luma(src, dst, width*height);
+		}else{
+			for(int i = 0; i < height; i++){
+				rows_->luma(src + i*srcStep, dst + width*i, width);
+			};
+		};
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		const unsigned char *s = src + i*srcStep;
+		for(int j = 0; j < width; j++){
+			dst[(width*i) + j] = (unsigned char) ((LUMA_B*s[j*srcChannels] + LUMA_G*s[j*srcChannels + 1]
+			                                     + LUMA_R*s[j*srcChannels + 2] + 128) >> 8);
+		};
+	};
+}
+
+
+static unsigned char clampByte(int v){
+	return (unsigned char) ((v < 0) ? 0 : ((v > 255) ? 255 : v));
+}
+
+static unsigned short partWeight(int part){
+	if(part < 0)   part = 0;
+	if(part > 100) part = 100;
+	return (unsigned short) ((part * 32768 + 99) / 100);
+}
+
+
+void prepareColorFilter(const ColorFilterParams &p, ColorFilterPrepared *prepared){
+	prepared->rThreshR = clampByte(p.rFilterThreshR);
+	prepared->rThreshG = clampByte(p.rFilterThreshG);
+	prepared->rThreshB = clampByte(p.rFilterThreshB);
+	prepared->gThreshR = clampByte(p.gFilterThreshR);
+	prepared->gThreshG = clampByte(p.gFilterThreshG);
+	prepared->gThreshB = clampByte(p.gFilterThreshB);
+	prepared->bThreshR = clampByte(p.bFilterThreshR);
+	prepared->bThreshG = clampByte(p.bFilterThreshG);
+	prepared->bThreshB = clampByte(p.bFilterThreshB);
+	prepared->weightR  = partWeight(p.sumPartR);
+	prepared->weightG  = partWeight(p.sumPartG);
+	prepared->weightB  = partWeight(p.sumPartB);
+	prepared->add      = clampByte(p.sumAdd);
+
+	// the filters as boxes: above a threshold is threshold+1 .. 255,
+	// below one is 0 .. threshold-1
+	ColorClass classes[3];
+	classes[0].minR = prepared->rThreshR + 1; classes[0].maxR = 255;
+	classes[0].minG = 0;                      classes[0].maxG = prepared->rThreshG - 1;
+	classes[0].minB = 0;                      classes[0].maxB = prepared->rThreshB - 1;
+	classes[1].minR = 0;                      classes[1].maxR = prepared->gThreshR - 1;
+	classes[1].minG = prepared->gThreshG + 1; classes[1].maxG = 255;
+	classes[1].minB = 0;                      classes[1].maxB = prepared->gThreshB - 1;
+	classes[2].minR = 0;                      classes[2].maxR = prepared->bThreshR - 1;
+	classes[2].minG = 0;                      classes[2].maxG = prepared->bThreshG - 1;
+	classes[2].minB = prepared->bThreshB + 1; classes[2].maxB = 255;
+	buildColorClassLut(classes, 3, &prepared->lut);
+}
+
+
+void colorFilter(const unsigned char *rgb, int width, int height, const ColorFilterPrepared &p,
+		unsigned char *outR, unsigned char *outG, unsigned char *outB, unsigned char *outSum, int outStep,
+		unsigned char *sum){
+	bool planes = (outR != NULL) || (outG != NULL) || (outB != NULL) || (outSum != NULL);
+	if(!planes || (outStep == width)){
+		rows_->filter(rgb, width*height, p, outR, outG, outB, outSum, sum);
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		rows_->filter(rgb + 3*width*i, width, p,
+				advance(outR, i*outStep), advance(outG, i*outStep), advance(outB, i*outStep), advance(outSum, i*outStep),
+				sum + width*i);
+	};
+}
+
+
+void colorFilterLut(const unsigned char *rgb, int width, int height, const ColorFilterPrepared &p,
+		unsigned char *outR, unsigned char *outG, unsigned char *outB, unsigned char *outSum, int outStep,
+		unsigned char *sum){
+	bool planes = (outR != NULL) || (outG != NULL) || (outB != NULL) || (outSum != NULL);
+	if(!planes || (outStep == width)){
+		rows_->filterLut(rgb, width*height, p, outR, outG, outB, outSum, sum);
+		return;
+	};
+
+	for(int i = 0; i < height; i++){
+		rows_->filterLut(rgb + 3*width*i, width, p,
+				advance(outR, i*outStep), advance(outG, i*outStep), advance(outB, i*outStep), advance(outSum, i*outStep),
+				sum + width*i);
+	};
+}
+
+
+void buildColorClassLut(const ColorClass *classes, int nmbClasses, ColorClassLut *lut){
+	memset(lut, 0, sizeof(ColorClassLut));
+	if(nmbClasses > COLOR_CLASSES_MAX) nmbClasses = COLOR_CLASSES_MAX;
+	for(int k = 0; k < nmbClasses; k++){
+		const ColorClass &c = classes[k];
+		unsigned char bit = (unsigned char) (1 << k);
+		for(int v = 0; v < 256; v++){
+			if((v >= c.minR) && (v <= c.maxR)) lut->r[v] |= bit;
+			if((v >= c.minG) && (v <= c.maxG)) lut->g[v] |= bit;
+			if((v >= c.minB) && (v <= c.maxB)) lut->b[v] |= bit;
+		};
+	};
+}
+
+
+void classifyColors(const unsigned char *rgb, int width, int height, const ColorClassLut &lut,
+		unsigned char *classes){
+	rows_->classify(rgb, width*height, lut, classes);
+}
+
+
+void colorFilter(const unsigned char *rgb, int width, int height, const ColorFilterParams &p,
+		unsigned char *outR, unsigned char *outG, unsigned char *outB, unsigned char *outSum, int outStep,
+		unsigned char *sum){
+	ColorFilterPrepared prepared;
+	prepareColorFilter(p, &prepared);
+	colorFilter(rgb, width, height, prepared, outR, outG, outB, outSum, outStep, sum);
+}
+
+
+void blobScan(const unsigned char *grey, int width, int height, int thresh, BlobScanResult *result){
+	blobScanWindow(grey, width, 0, 0, width, height, thresh, result);
+}
+
+
+void clearBlobScan(BlobScanResult *result){
+	result->firstRow = result->firstRowX = -1;
+	result->lastRow  = result->lastRowX  = -1;
+	result->firstCol = result->firstColY = -1;
+	result->lastCol  = result->lastColY  = -1;
+	result->count = 0;
+	result->sumX  = 0;
+	result->sumY  = 0;
+}
+
+
+void mergeBlobScan(const BlobScanResult &part, BlobScanResult *result){
+	if(part.count == 0){
+		return;
+	};
+	if(result->count == 0){
+		*result = part;
+		return;
+	};
+	// ties as in blobScan(): leftmost pixel of the topmost row, rightmost
+	// of the bottommost row, topmost of the leftmost column, bottommost of
+	// the rightmost column
+	if((part.firstRow < result->firstRow) ||
+	   ((part.firstRow == result->firstRow) && (part.firstRowX < result->firstRowX))){
+		result->firstRow  = part.firstRow;
+		result->firstRowX = part.firstRowX;
+	};
+	if((part.lastRow > result->lastRow) ||
+	   ((part.lastRow == result->lastRow) && (part.lastRowX > result->lastRowX))){
+		result->lastRow  = part.lastRow;
+		result->lastRowX = part.lastRowX;
+	};
+	if((part.firstCol < result->firstCol) ||
+	   ((part.firstCol == result->firstCol) && (part.firstColY < result->firstColY))){
+		result->firstCol  = part.firstCol;
+		result->firstColY = part.firstColY;
+	};
+	if((part.lastCol > result->lastCol) ||
+	   ((part.lastCol == result->lastCol) && (part.lastColY > result->lastColY))){
+		result->lastCol  = part.lastCol;
+		result->lastColY = part.lastColY;
+	};
+	result->count += part.count;
+	result->sumX  += part.sumX;
+	result->sumY  += part.sumY;
+}
+
+
+// adds row i of a scan, the columns counted from x0; the rows are added
+// top down
+static void addBlobRow(BlobRow &row, int i, int x0, BlobScanResult *result){
+	if(row.count == 0){
+		return;
+	};
+	row.first += x0;
+	row.last  += x0;
+	row.sumX  += (long long) x0 * row.count;
+	// the topmost pixel of the leftmost column is in the first row
+	// reaching that column, the bottommost pixel of the rightmost column
+	// in the last row reaching that column
+	if(result->firstRow < 0){
+		result->firstRow  = i;
+		result->firstRowX = row.first;
+	};
+	result->lastRow  = i;
+	result->lastRowX = row.last;
+	if((result->firstCol < 0) || (row.first < result->firstCol)){
+		result->firstCol  = row.first;
+		result->firstColY = i;
+	};
+	if(row.last >= result->lastCol){
+		result->lastCol  = row.last;
+		result->lastColY = i;
+	};
+	result->count += row.count;
+	result->sumX  += row.sumX;
+	result->sumY  += (long long) i * row.count;
+}
+
+
+void blobScanWindow(const unsigned char *grey, int width, int x0, int y0, int x1, int y1, int thresh,
+		BlobScanResult *result){
+	clearBlobScan(result);
+	if((thresh >= 255) || (x1 <= x0)){
+		return;
+	};
+	unsigned char above = (unsigned char) ((thresh < 0) ? 0 : thresh + 1);
+
+	BlobRow row;
+	for(int i = y0; i < y1; i++){
+		rows_->blob(grey + (long) width*i + x0, x1 - x0, above, &row);
+		addBlobRow(row, i, x0, result);
+	};
+}
+
+
+void colorBlobScan(const unsigned char *rgb, int width, int height, const ColorFilterPrepared &p, int thresh,
+		BlobScanResult *result){
+	colorBlobScanWindow(rgb, width, 0, 0, width, height, p, thresh, result);
+}
+
+
+void colorBlobScanWindow(const unsigned char *rgb, int width, int x0, int y0, int x1, int y1,
+		const ColorFilterPrepared &p, int thresh, BlobScanResult *result){
+	clearBlobScan(result);
+	if((thresh >= 255) || (x1 <= x0)){
+		return;
+	};
+	unsigned char above = (unsigned char) ((thresh < 0) ? 0 : thresh + 1);
+
+	BlobRow row;
+	for(int i = y0; i < y1; i++){
+		rows_->filterBlob(rgb + 3*((long) width*i + x0), x1 - x0, p, above, &row);
+		addBlobRow(row, i, x0, result);
+	};
+}
+
+
+void maxPool2(const unsigned char *src, int width, int height, unsigned char *dst){
+	int outWidth = (width + 1) / 2;
+	for(int i = 0; 2*i < height; i++){
+		const unsigned char *row0 = src + (long) width*2*i;
+		const unsigned char *row1 = (2*i + 1 < height) ? row0 + width : row0;
+		unsigned char *out = dst + (long) outWidth*i;
+		rows_->maxPool(row0, row1, width / 2, out);
+		if(width & 1){
+			out[outWidth - 1] = (row0[width - 1] > row1[width - 1]) ? row0[width - 1] : row1[width - 1];
+		};
+	};
+}
+
+
+int thresholdRuns(const unsigned char *grey, int width, int thresh, int *bounds){
+	if(thresh >= 255){
+		return 0;
+	};
+	return rows_->runs(grey, width, (unsigned char) ((thresh < 0) ? 0 : thresh + 1), bounds);
+}
+
+
+unsigned char randomByte(){
+	unsigned int i = ((unsigned int) 255*((float)rand()) / ((float) RAND_MAX));
+	return ((unsigned char) i);
+}
+
+
+void randomFill(char *dst, int size){
+	for(int i = 0; i < size; i++){
+		dst[i] = randomByte();
+	};
+}
+
+
+void randomSeed(RandomState *state, unsigned long long seed){
+	// splitmix64, never yields an all zero xorshift state
+	for(int l = 0; l < RANDOM_LANES; l++){
+		for(int k = 0; k < 2; k++){
+			unsigned long long z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			z =  z ^ (z >> 31);
+			if(k == 0) state->s0[l] = z; else state->s1[l] = z;
+		};
+	};
+}
+
+
+void randomFillFast(RandomState *state, char *dst, int size){
+	unsigned long long s0[RANDOM_LANES], s1[RANDOM_LANES], block[RANDOM_LANES];
+	memcpy(s0, state->s0, sizeof(s0));
+	memcpy(s1, state->s1, sizeof(s1));
+
+	while(size > 0){
+		// one xorshift128+ step of all lanes
+		for(int l = 0; l < RANDOM_LANES; l++){
+			unsigned long long x = s0[l];
+			unsigned long long y = s1[l];
+			s0[l] = y;
+			x ^= x << 23;
+			x ^= x >> 17;
+			x ^= y ^ (y >> 26);
+			s1[l] = x;
+			block[l] = x + y;
+		};
+
+		int n = (size < (int) sizeof(block)) ? size : (int) sizeof(block);
+		memcpy(dst, block, n);
+		dst  += n;
+		size -= n;
+	};
+
+	memcpy(state->s0, s0, sizeof(s0));
+	memcpy(state->s1, s1, sizeof(s1));
+}
+
+
+} // end namespace ImgKernels
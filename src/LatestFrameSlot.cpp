@@ -0,0 +1,107 @@
+/*
+ * LatestFrameSlot.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/LatestFrameSlot.H"
+
+#include <cstring>
+
+
+LatestFrameSlot::LatestFrameSlot(int frameSize, int nmbReaders){
+	frameSize_  = frameSize;
+	nmbBuffers_ = ((nmbReaders < 1) ? 1 : nmbReaders) + 2;
+	buffers_    = new Buffer[nmbBuffers_];
+	for(int k = 0; k < nmbBuffers_; k++){
+		buffers_[k].data      = new unsigned char[frameSize_];
+		buffers_[k].timeStamp = 0;
+		buffers_[k].seq       = 0;
+		buffers_[k].refs      = 0;
+		buffers_[k].taken     = false;
+		memset(buffers_[k].data, 0, frameSize_);
+	};
+	latest_   = -1;
+	writing_  = -1;
+	published_ = 0;
+	dropped_   = 0;
+	overruns_  = 0;
+}
+
+
+LatestFrameSlot::~LatestFrameSlot(){
+	for(int k = 0; k < nmbBuffers_; k++){
+		delete [] buffers_[k].data;
+	};
+	delete [] buffers_;
+}
+
+
+unsigned char *LatestFrameSlot::writeBuffer(){
+	// a buffer which is neither the latest one nor held by a reader; a
+	// reader which increments the count of a buffer after this test
+	// finds it not being the latest one any more and lets it go again
+	int latest = latest_;
+	for(int k = 0; k < nmbBuffers_; k++){
+		if((k != latest) && (buffers_[k].refs == 0)){
+			writing_ = k;
+			return buffers_[k].data;
+		};
+	};
+	writing_ = -1;
+	overruns_++;
+	return NULL;
+}
+
+
+void LatestFrameSlot::publish(uint64_t timeStamp){
+	if(writing_ < 0){
+		return;
+	};
+	Buffer &b = buffers_[writing_];
+	b.timeStamp = timeStamp;
+	b.seq       = ++published_;
+	b.taken     = false;
+
+	int previous = latest_.exchange(writing_);
+	if((previous >= 0) && !buffers_[previous].taken){
+		dropped_++;
+	};
+	writing_ = -1;
+}
+
+
+bool LatestFrameSlot::acquire(LatestFrame *frame){
+	for(;;){
+		int k = latest_;
+		if(k < 0){
+			return false;
+		};
+		buffers_[k].refs++;
+		buffers_[k].taken = true;
+		if(latest_ == k){
+			// still the latest one, the producer won't touch it any more
+			frame->data      = buffers_[k].data;
+			frame->timeStamp = buffers_[k].timeStamp;
+			frame->seq       = buffers_[k].seq;
+			frame->buffer    = k;
+			return true;
+		};
+		buffers_[k].refs--;
+	};
+}
+
+
+void LatestFrameSlot::release(LatestFrame *frame){
+	if(frame->buffer >= 0){
+		buffers_[frame->buffer].refs--;
+		frame->buffer = -1;
+		frame->data   = NULL;
+	};
+}
+
+
+unsigned long LatestFrameSlot::latestSeq(){
+	int k = latest_;
+	return (k < 0) ? 0 : buffers_[k].seq;
+}
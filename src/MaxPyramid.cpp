@@ -0,0 +1,60 @@
+/*
+ * MaxPyramid.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/MaxPyramid.H"
+
+#include <cstdlib>
+
+
+MaxPyramid::MaxPyramid(int levels){
+	levels_ = (levels > 0) ? levels : 0;
+	grey_   = NULL;
+	pooled_.resize(levels_);
+	widths_.assign(levels_ + 1, 0);
+	heights_.assign(levels_ + 1, 0);
+}
+
+
+void MaxPyramid::build(const unsigned char *grey, int width, int height){
+	grey_       = grey;
+	widths_[0]  = width;
+	heights_[0] = height;
+	for(int k = 1; k <= levels_; k++){
+		widths_[k]  = (widths_[k - 1] + 1) / 2;
+		heights_[k] = (heights_[k - 1] + 1) / 2;
+		pooled_[k - 1].resize((long) widths_[k] * heights_[k] + 1);
+		ImgKernels::maxPool2(level(k - 1), widths_[k - 1], heights_[k - 1], &pooled_[k - 1][0]);
+	};
+}
+
+
+void MaxPyramid::blobScan(int thresh, ImgKernels::BlobScanResult *result){
+	ImgKernels::clearBlobScan(result);
+	if(grey_ == NULL){
+		return;
+	};
+
+	int width   = widths_[0];
+	int height  = heights_[0];
+	int coarseW = widths_[levels_];
+	int block   = 1 << levels_;
+	bounds_.resize(coarseW + 1);
+
+	// every run of coarse pixels above the threshold is a window of
+	// blocks at full resolution
+	ImgKernels::BlobScanResult part;
+	for(int i = 0; i < heights_[levels_]; i++){
+		int nmbBounds = ImgKernels::thresholdRuns(level(levels_) + (long) coarseW*i, coarseW, thresh, &bounds_[0]);
+		int y0 = i * block;
+		int y1 = (y0 + block < height) ? y0 + block : height;
+		for(int k = 0; k < nmbBounds; k += 2){
+			int x0 = bounds_[k] * block;
+			int x1 = (bounds_[k + 1] * block < width) ? bounds_[k + 1] * block : width;
+			ImgKernels::blobScanWindow(grey_, width, x0, y0, x1, y1, thresh, &part);
+			ImgKernels::mergeBlobScan(part, result);
+		};
+	};
+}
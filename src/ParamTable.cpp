@@ -0,0 +1,133 @@
+/*
+ * ParamTable.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/ParamTable.H"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <cerrno>
+
+
+// splits "a,b,c" into its tokens, blanks around the tokens are removed
+static vector<string> splitList(const char *list){
+	vector<string> tokens;
+	string token;
+	for(const char *c = list; ; c++){
+		if((*c == ',') || (*c == '\0')){
+			size_t first = token.find_first_not_of(" \t\r\n");
+			size_t last  = token.find_last_not_of(" \t\r\n");
+			tokens.push_back((first == string::npos) ? string("") : token.substr(first, last - first + 1));
+			token.clear();
+			if(*c == '\0') break;
+		}else{
+			token += *c;
+		};
+	};
+	return tokens;
+}
+
+
+ParamTable::ParamTable(){
+	version_ = 0;
+	pthread_mutex_init(&mutex_, NULL);
+}
+
+
+ParamTable::~ParamTable(){
+	pthread_mutex_destroy(&mutex_);
+}
+
+
+void ParamTable::add(const char *name, int *value, int min, int max){
+	Param p;
+	p.name  = string(name);
+	p.value = value;
+	p.min   = min;
+	p.max   = max;
+	lock();
+	params_.push_back(p);
+	unlock();
+}
+
+
+int ParamTable::find(const string &name){
+	for(size_t k = 0; k < params_.size(); k++){
+		if(params_[k].name == name) return (int) k;
+	};
+	return -1;
+}
+
+
+string ParamTable::set(const char *assignments){
+	vector<string> tokens = splitList(assignments);
+	vector<int>    index(tokens.size());
+	vector<int>    value(tokens.size());
+
+	// check all assignments before the first one is applied
+	for(size_t t = 0; t < tokens.size(); t++){
+		size_t eq = tokens[t].find('=');
+		if(eq == string::npos){
+			return string("[ERROR=expected name=value]");
+		};
+		string name = tokens[t].substr(0, eq);
+		name = name.substr(0, name.find_last_not_of(" \t") + 1);
+		index[t] = find(name);
+		if(index[t] < 0){
+			return string("[ERROR=unknown parameter ") + name + string("]");
+		};
+
+		const char *number = tokens[t].c_str() + eq + 1;
+		char *end;
+		errno = 0;
+		long v = strtol(number, &end, 10);
+		while(isspace(*end)) end++;
+		if((end == number) || (*end != '\0') || (errno != 0)){
+			return string("[ERROR=no integer value for ") + name + string("]");
+		};
+		const Param &p = params_[index[t]];
+		value[t] = (v < p.min) ? p.min : ((v > p.max) ? p.max : (int) v);
+	};
+
+	lock();
+	for(size_t t = 0; t < tokens.size(); t++){
+		*(params_[index[t]].value) = value[t];
+	};
+	version_++;
+	unlock();
+	return string("[OK]");
+}
+
+
+string ParamTable::get(const char *names){
+	vector<string> tokens = splitList(names);
+	if((tokens.size() == 1) && tokens[0].empty()){
+		tokens.clear();
+		for(size_t k = 0; k < params_.size(); k++){
+			tokens.push_back(params_[k].name);
+		};
+	};
+
+	vector<int> index(tokens.size());
+	for(size_t t = 0; t < tokens.size(); t++){
+		index[t] = find(tokens[t]);
+		if(index[t] < 0){
+			return string("[ERROR=unknown parameter ") + tokens[t] + string("]");
+		};
+	};
+
+	string reply("[");
+	char number[16];
+	lock();
+	for(size_t t = 0; t < tokens.size(); t++){
+		sprintf(number, "%d", *(params_[index[t]].value));
+		if(t > 0) reply += string(",");
+		reply += tokens[t] + string("=") + string(number);
+	};
+	unlock();
+	reply += string("]");
+	return reply;
+}
@@ -26,15 +26,26 @@
 #else
   #include <sys/types.h>       // For data types
   #include <sys/socket.h>      // For socket(), connect(), send(), and recv()
-  #include <netdb.h>           // For gethostbyname()
+  #include <netdb.h>           // For getaddrinfo()
   #include <arpa/inet.h>       // For inet_addr()
   #include <unistd.h>          // For close()
   #include <netinet/in.h>      // For sockaddr_in
+  #include <sys/uio.h>         // For iovec
+  #include <poll.h>            // For poll()
+  #include <fcntl.h>           // For fcntl()
+  #include <time.h>            // For clock_gettime()
   typedef void raw_type;       // Type used for raw data on this platform
 #endif
 
+#ifdef __linux__
+  #include <sys/epoll.h>       // For SocketPoller
+#endif
+
 #include <cerrno> // For errno
 #include <string>
+#include <vector>
+#include <map>
+#include <pthread.h>
 
 using namespace std;
 
@@ -59,21 +70,150 @@ const char *SocketException::what() const throw() {
   return userMessage.c_str();
 }
 
-// Function to fill in address structure given an address and port
-static void fillAddr(const string &address, unsigned short port,
-                     sockaddr_in &addr) {
-  memset(&addr, 0, sizeof(addr));  // Zero out address structure
-  addr.sin_family = AF_INET;       // Internet address
+SocketTimeoutException::SocketTimeoutException(const string &message)
+  throw() : SocketException(message) {
+}
+
+// Monotonic clock in milli seconds for the deadlines
+static long long monotonicMs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((long long) now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+// Would the call have blocked on a non-blocking socket (or with MSG_DONTWAIT)
+static bool wouldBlock() {
+  return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+}
+
+// SocketAddress Code
+
+// A name resolved with port 0, reused until expires (monotonic ms)
+struct ResolvedName {
+  SocketAddress address;
+  long long expires;
+};
+
+static map<string, ResolvedName> resolvedNames;
+static pthread_mutex_t resolvedMutex = PTHREAD_MUTEX_INITIALIZER;
+static int resolveTtlS = SOCKET_RESOLVE_TTL_S;
+
+SocketAddress::SocketAddress() {
+  memset(&storage, 0, sizeof(storage));
+  length = 0;
+}
+
+SocketAddress::SocketAddress(const sockaddr *addr, int addrLen) {
+  memset(&storage, 0, sizeof(storage));
+  length = 0;
+  if ((addrLen > 0) && (addrLen <= (int) sizeof(storage.bytes))
+      && ((addr->sa_family == AF_INET) || (addr->sa_family == AF_INET6))) {
+    memcpy(storage.bytes, addr, addrLen);
+    length = addrLen;
+  }
+}
+
+SocketAddress::SocketAddress(const string &address, unsigned short port)
+    throw(SocketException) {
+  memset(&storage, 0, sizeof(storage));
+  length = 0;
+  long long now = monotonicMs();
+  bool found = false;
+  pthread_mutex_lock(&resolvedMutex);
+  map<string, ResolvedName>::iterator k = resolvedNames.find(address);
+  if ((k != resolvedNames.end()) && (k->second.expires > now)) {
+    *this = k->second.address;
+    found = true;
+  }
+  pthread_mutex_unlock(&resolvedMutex);
+
+  if (!found) {
+    // the resolver may take long, the cache is not locked meanwhile
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;    // one entry per address
+    addrinfo *result;
+    int rtn = getaddrinfo(address.c_str(), NULL, &hints, &result);
+    if (rtn != 0) {
+      throw SocketException(string("Failed to resolve name (getaddrinfo()): ")
+                            + gai_strerror(rtn));
+    }
+    // IPv4 first, the servers listen on any IPv4 interface (setLocalPort())
+    for (addrinfo *r = result; (r != NULL) && (getFamily() != AF_INET); r = r->ai_next) {
+      if ((r->ai_family == AF_INET) || !isValid()) {
+        *this = SocketAddress(r->ai_addr, (int) r->ai_addrlen);
+      }
+    }
+    freeaddrinfo(result);
+    if (!isValid()) {
+      throw SocketException("Failed to resolve name (no IPv4 or IPv6 address)");
+    }
+
+    pthread_mutex_lock(&resolvedMutex);
+    for (k = resolvedNames.begin(); k != resolvedNames.end(); ) {
+      if (k->second.expires <= now) {
+        resolvedNames.erase(k++);
+      } else {
+        k++;
+      }
+    }
+    if (resolveTtlS > 0) {
+      ResolvedName name;
+      name.address = *this;
+      name.expires = now + 1000LL * resolveTtlS;
+      resolvedNames[address] = name;
+    }
+    pthread_mutex_unlock(&resolvedMutex);
+  }
+  setPort(port);
+}
+
+int SocketAddress::getFamily() const {
+  return (length > 0) ? getSockAddr()->sa_family : AF_UNSPEC;
+}
+
+string SocketAddress::getAddress() const {
+  char host[NI_MAXHOST];
+  if ((length == 0) || (getnameinfo(getSockAddr(), length, host, sizeof(host),
+                                    NULL, 0, NI_NUMERICHOST) != 0)) {
+    return "";
+  }
+  return host;
+}
+
+unsigned short SocketAddress::getPort() const {
+  if (getFamily() == AF_INET6) {
+    return ntohs(((const sockaddr_in6 *) storage.bytes)->sin6_port);
+  }
+  if (getFamily() == AF_INET) {
+    return ntohs(((const sockaddr_in *) storage.bytes)->sin_port);
+  }
+  return 0;
+}
 
-  hostent *host;  // Resolve name
-  if ((host = gethostbyname(address.c_str())) == NULL) {
-    // strerror() will not work for gethostbyname() and hstrerror()
-    // is supposedly obsolete
-    throw SocketException("Failed to resolve name (gethostbyname())");
+void SocketAddress::setPort(unsigned short port) {
+  if (getFamily() == AF_INET6) {
+    ((sockaddr_in6 *) storage.bytes)->sin6_port = htons(port);
+  } else if (getFamily() == AF_INET) {
+    ((sockaddr_in *) storage.bytes)->sin_port = htons(port);
   }
-  addr.sin_addr.s_addr = *((unsigned long *) host->h_addr_list[0]);
+}
 
-  addr.sin_port = htons(port);     // Assign port in network byte order
+const sockaddr *SocketAddress::getSockAddr() const {
+  return (const sockaddr *) storage.bytes;
+}
+
+void SocketAddress::setCacheTtl(int ttlS) {
+  pthread_mutex_lock(&resolvedMutex);
+  resolveTtlS = ttlS;
+  pthread_mutex_unlock(&resolvedMutex);
+}
+
+void SocketAddress::clearCache() {
+  pthread_mutex_lock(&resolvedMutex);
+  resolvedNames.clear();
+  pthread_mutex_unlock(&resolvedMutex);
 }
 
 // Socket Code
@@ -92,14 +232,29 @@ Socket::Socket(int type, int protocol) throw(SocketException) {
     }
   #endif
 
-  // Make a new socket
+  // Make a new socket, IPv4 until used with an IPv6 address
   if ((sockDesc = socket(PF_INET, type, protocol)) < 0) {
     throw SocketException("Socket creation failed (socket())", true);
   }
+  this->family = AF_INET;
+  this->type = type;
+  this->protocol = protocol;
+  blocking = true;
+  timeoutMs = -1;
 }
 
 Socket::Socket(int sockDesc) {
   this->sockDesc = sockDesc;
+  sockaddr_storage addr;
+  socklen_t addrLen = sizeof(addr);
+  family = (getsockname(sockDesc, (sockaddr *) &addr, &addrLen) < 0) ? AF_INET : addr.ss_family;
+  int sockType = SOCK_STREAM;
+  socklen_t typeLen = sizeof(sockType);
+  getsockopt(sockDesc, SOL_SOCKET, SO_TYPE, (raw_type *) &sockType, &typeLen);
+  type = sockType;
+  protocol = 0;
+  blocking = true;
+  timeoutMs = -1;
 }
 
 Socket::~Socket() {
@@ -112,23 +267,23 @@ Socket::~Socket() {
 }
 
 string Socket::getLocalAddress() throw(SocketException) {
-  sockaddr_in addr;
-  unsigned int addr_len = sizeof(addr);
+  sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
 
-  if (getsockname(sockDesc, (sockaddr *) &addr, (socklen_t *) &addr_len) < 0) {
+  if (getsockname(sockDesc, (sockaddr *) &addr, &addr_len) < 0) {
     throw SocketException("Fetch of local address failed (getsockname())", true);
   }
-  return inet_ntoa(addr.sin_addr);
+  return SocketAddress((sockaddr *) &addr, addr_len).getAddress();
 }
 
 unsigned short Socket::getLocalPort() throw(SocketException) {
-  sockaddr_in addr;
-  unsigned int addr_len = sizeof(addr);
+  sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
 
-  if (getsockname(sockDesc, (sockaddr *) &addr, (socklen_t *) &addr_len) < 0) {
+  if (getsockname(sockDesc, (sockaddr *) &addr, &addr_len) < 0) {
     throw SocketException("Fetch of local port failed (getsockname())", true);
   }
-  return ntohs(addr.sin_port);
+  return SocketAddress((sockaddr *) &addr, addr_len).getPort();
 }
 
 void Socket::setLocalPort(unsigned short localPort) throw(SocketException) {
@@ -147,14 +302,43 @@ void Socket::setLocalPort(unsigned short localPort) throw(SocketException) {
 void Socket::setLocalAddressAndPort(const string &localAddress,
     unsigned short localPort) throw(SocketException) {
   // Get the address of the requested host
-  sockaddr_in localAddr;
-  fillAddr(localAddress, localPort, localAddr);
+  setLocalAddressAndPort(SocketAddress(localAddress, localPort));
+}
 
-  if (bind(sockDesc, (sockaddr *) &localAddr, sizeof(sockaddr_in)) < 0) {
+void Socket::setLocalAddressAndPort(const SocketAddress &localAddress)
+    throw(SocketException) {
+  useFamily(localAddress.getFamily());
+  if (bind(sockDesc, localAddress.getSockAddr(), localAddress.getLength()) < 0) {
     throw SocketException("Set of local address and port failed (bind())", true);
   }
 }
 
+void Socket::useFamily(int family) throw(SocketException) {
+  if (family == this->family) {
+    return;
+  }
+  sockaddr_storage addr;
+  socklen_t addrLen = sizeof(addr);
+  if ((getsockname(sockDesc, (sockaddr *) &addr, &addrLen) == 0)
+      && (SocketAddress((sockaddr *) &addr, addrLen).getPort() != 0)) {
+    throw SocketException("Address family differs from the bound socket's");
+  }
+  int newDesc = socket(family, type, protocol);
+  if (newDesc < 0) {
+    throw SocketException("Socket creation failed (socket())", true);
+  }
+  // the descriptor stays the same, a poller or another thread may know it
+  if (dup2(newDesc, sockDesc) < 0) {
+    ::close(newDesc);
+    throw SocketException("Socket replacement failed (dup2())", true);
+  }
+  ::close(newDesc);
+  this->family = family;
+  if (!blocking) {
+    setBlocking(false);
+  }
+}
+
 void Socket::cleanUp() throw(SocketException) {
   #ifdef WIN32
     if (WSACleanup() != 0) {
@@ -163,6 +347,56 @@ void Socket::cleanUp() throw(SocketException) {
   #endif
 }
 
+void Socket::setBlocking(bool blocking) throw(SocketException) {
+  int flags = fcntl(sockDesc, F_GETFL, 0);
+  if (flags < 0) {
+    throw SocketException("Fetch of socket flags failed (fcntl())", true);
+  }
+  flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+  if (fcntl(sockDesc, F_SETFL, flags) < 0) {
+    throw SocketException("Set of blocking mode failed (fcntl())", true);
+  }
+  this->blocking = blocking;
+}
+
+bool Socket::waitFor(short events, int timeoutMs) throw(SocketException) {
+  struct pollfd p;
+  p.fd = sockDesc;
+  p.events = events;
+  p.revents = 0;
+  int rtn;
+  while ((rtn = ::poll(&p, 1, timeoutMs)) < 0) {
+    if (errno != EINTR) {
+      throw SocketException("Wait for socket failed (poll())", true);
+    }
+  }
+  return (rtn > 0);
+}
+
+bool Socket::waitReadable(int timeoutMs) throw(SocketException) {
+  return waitFor(POLLIN, timeoutMs);
+}
+
+bool Socket::waitWritable(int timeoutMs) throw(SocketException) {
+  return waitFor(POLLOUT, timeoutMs);
+}
+
+long long Socket::deadline() {
+  return (timeoutMs < 0) ? -1 : monotonicMs() + timeoutMs;
+}
+
+void Socket::waitUntil(short events, long long deadline)
+    throw(SocketException) {
+  int left = -1;
+  if (deadline >= 0) {
+    long long rest = deadline - monotonicMs();
+    left = (rest < 0) ? 0 : (int) rest;
+  }
+  if (!waitFor(events, left)) {
+    throw SocketTimeoutException("Deadline of the socket passed");
+  }
+}
+
 unsigned short Socket::resolveService(const string &service,
                                       const string &protocol) {
   struct servent *serv;        /* Structure containing service information */
@@ -185,51 +419,251 @@ CommunicatingSocket::CommunicatingSocket(int newConnSD) : Socket(newConnSD) {
 void CommunicatingSocket::connect(const string &foreignAddress,
     unsigned short foreignPort) throw(SocketException) {
   // Get the address of the requested host
-  sockaddr_in destAddr;
-  fillAddr(foreignAddress, foreignPort, destAddr);
+  connect(SocketAddress(foreignAddress, foreignPort));
+}
 
-  // Try to connect to the given port
-  if (::connect(sockDesc, (sockaddr *) &destAddr, sizeof(destAddr)) < 0) {
+void CommunicatingSocket::connect(const SocketAddress &foreignAddress)
+    throw(SocketException) {
+  useFamily(foreignAddress.getFamily());
+  long long until = deadline();
+
+  // Without a deadline connect() waits as long as the system does,
+  // otherwise it is started non-blocking and waited for in poll()
+  bool restore = (until >= 0) && blocking;
+  if (restore) {
+    setBlocking(false);
+  }
+  int rtn = ::connect(sockDesc, foreignAddress.getSockAddr(), foreignAddress.getLength());
+  if ((rtn < 0) && (errno == EINPROGRESS)) {
+    try {
+      waitUntil(POLLOUT, until);
+    } catch (SocketException &) {
+      if (restore) setBlocking(true);
+      throw;
+    }
+    int error = 0;
+    socklen_t errorLen = sizeof(error);
+    getsockopt(sockDesc, SOL_SOCKET, SO_ERROR, (raw_type *) &error, &errorLen);
+    errno = error;
+    rtn = (error == 0) ? 0 : -1;
+  }
+  int connectErrno = errno;
+  if (restore) {
+    setBlocking(true);
+  }
+  if (rtn < 0) {
+    errno = connectErrno;
     throw SocketException("Connect failed (connect())", true);
   }
 }
 
+// a peer closing the connection makes send() throw instead of raising
+// SIGPIPE
+#ifdef MSG_NOSIGNAL
+  #define SEND_FLAGS MSG_NOSIGNAL
+#else
+  #define SEND_FLAGS 0
+#endif
+
+// With a deadline the calls don't wait in the system but in poll(), the
+// deadline of which is checked
+#define DEADLINE_FLAGS(until) (((until) >= 0) ? MSG_DONTWAIT : 0)
+
 void CommunicatingSocket::send(const void *buffer, int bufferLen)
     throw(SocketException) {
-  if (::send(sockDesc, (raw_type *) buffer, bufferLen, 0) < 0) {
+  long long until = deadline();
+  int total = 0;
+  while (total < bufferLen) {
+    // a signal may interrupt the send after a part of the buffer
+    int rtn = ::send(sockDesc, (raw_type *) (((const char *) buffer) + total), bufferLen - total,
+                     SEND_FLAGS | DEADLINE_FLAGS(until));
+    if (rtn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (wouldBlock()) {
+        waitUntil(POLLOUT, until);
+        continue;
+      }
+      throw SocketException("Send failed (send())", true);
+    }
+    total += rtn;
+  }
+}
+
+int CommunicatingSocket::sendSome(const void *buffer, int bufferLen)
+    throw(SocketException) {
+  int rtn;
+  do {
+    rtn = ::send(sockDesc, (raw_type *) buffer, bufferLen, SEND_FLAGS | MSG_DONTWAIT);
+  } while ((rtn < 0) && (errno == EINTR));
+  if (rtn < 0) {
+    if (wouldBlock()) {
+      return 0;
+    }
     throw SocketException("Send failed (send())", true);
   }
+  return rtn;
+}
+
+#ifndef WIN32
+// Advances iov, a copy of the caller's buffers, past n bytes written or
+// read; returns the index of the first buffer not done
+static int advanceIov(vector<struct iovec> &iov, int first, size_t n) {
+  while ((first < (int) iov.size()) && (n >= iov[first].iov_len)) {
+    n -= iov[first].iov_len;
+    first++;
+  }
+  if (first < (int) iov.size()) {
+    iov[first].iov_base = ((char *) iov[first].iov_base) + n;
+    iov[first].iov_len -= n;
+  }
+  return first;
 }
 
+void CommunicatingSocket::sendv(const struct iovec *iov, int iovcnt)
+    throw(SocketException) {
+  long long until = deadline();
+  vector<struct iovec> rest(iov, iov + iovcnt);
+  int first = advanceIov(rest, 0, 0);    // skips empty buffers
+  while (first < iovcnt) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = &rest[first];
+    msg.msg_iovlen = iovcnt - first;
+    ssize_t rtn = ::sendmsg(sockDesc, &msg, SEND_FLAGS | DEADLINE_FLAGS(until));
+    if (rtn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (wouldBlock()) {
+        waitUntil(POLLOUT, until);
+        continue;
+      }
+      throw SocketException("Send failed (sendmsg())", true);
+    }
+    first = advanceIov(rest, first, (size_t) rtn);
+  }
+}
+#endif
+
 int CommunicatingSocket::recv(void *buffer, int bufferLen)
     throw(SocketException) {
+  long long until = deadline();
   int rtn;
-  if ((rtn = ::recv(sockDesc, (raw_type *) buffer, bufferLen, 0)) < 0) {
+  while ((rtn = ::recv(sockDesc, (raw_type *) buffer, bufferLen, DEADLINE_FLAGS(until))) < 0) {
+    if (errno == EINTR) {
+      continue;
+    }
+    if (wouldBlock()) {
+      if (!blocking) {
+        return -1;
+      }
+      waitUntil(POLLIN, until);
+      continue;
+    }
     throw SocketException("Received failed (recv())", true);
   }
 
   return rtn;
 }
 
+int CommunicatingSocket::recvAll(void *buffer, int bufferLen)
+    throw(SocketException) {
+  long long until = deadline();
+  // MSG_WAITALL waits in the system for all bytes, not with a deadline
+  int flags = (until >= 0) ? MSG_DONTWAIT : MSG_WAITALL;
+  int total = 0;
+  while (total < bufferLen) {
+    // MSG_WAITALL may still return early, e.g. on a signal
+    int rtn = ::recv(sockDesc, (raw_type *) (((char *) buffer) + total), bufferLen - total, flags);
+    if (rtn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (wouldBlock()) {
+        if (!blocking) {
+          break;
+        }
+        waitUntil(POLLIN, until);
+        continue;
+      }
+      throw SocketException("Received failed (recv())", true);
+    }
+    if (rtn == 0) {
+      break;
+    }
+    total += rtn;
+  }
+
+  return total;
+}
+
+#ifndef WIN32
+int CommunicatingSocket::recvv(const struct iovec *iov, int iovcnt)
+    throw(SocketException) {
+  long long until = deadline();
+  int flags = (until >= 0) ? MSG_DONTWAIT : MSG_WAITALL;
+  vector<struct iovec> rest(iov, iov + iovcnt);
+  int first = advanceIov(rest, 0, 0);
+  int total = 0;
+  while (first < iovcnt) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = &rest[first];
+    msg.msg_iovlen = iovcnt - first;
+    ssize_t rtn = ::recvmsg(sockDesc, &msg, flags);
+    if (rtn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (wouldBlock()) {
+        if (!blocking) {
+          break;
+        }
+        waitUntil(POLLIN, until);
+        continue;
+      }
+      throw SocketException("Received failed (recvmsg())", true);
+    }
+    if (rtn == 0) {
+      break;
+    }
+    total += (int) rtn;
+    first = advanceIov(rest, first, (size_t) rtn);
+  }
+
+  return total;
+}
+#endif
+
 string CommunicatingSocket::getForeignAddress()
     throw(SocketException) {
-  sockaddr_in addr;
-  unsigned int addr_len = sizeof(addr);
+  sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
 
-  if (getpeername(sockDesc, (sockaddr *) &addr,(socklen_t *) &addr_len) < 0) {
+  if (getpeername(sockDesc, (sockaddr *) &addr, &addr_len) < 0) {
     throw SocketException("Fetch of foreign address failed (getpeername())", true);
   }
-  return inet_ntoa(addr.sin_addr);
+  return SocketAddress((sockaddr *) &addr, addr_len).getAddress();
 }
 
 unsigned short CommunicatingSocket::getForeignPort() throw(SocketException) {
-  sockaddr_in addr;
-  unsigned int addr_len = sizeof(addr);
+  sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
 
-  if (getpeername(sockDesc, (sockaddr *) &addr, (socklen_t *) &addr_len) < 0) {
+  if (getpeername(sockDesc, (sockaddr *) &addr, &addr_len) < 0) {
     throw SocketException("Fetch of foreign port failed (getpeername())", true);
   }
-  return ntohs(addr.sin_port);
+  return SocketAddress((sockaddr *) &addr, addr_len).getPort();
+}
+
+void CommunicatingSocket::shutdown() {
+  #ifdef WIN32
+    ::shutdown(sockDesc, SD_BOTH);
+  #else
+    ::shutdown(sockDesc, SHUT_RDWR);
+  #endif
 }
 
 // TCPSocket Code
@@ -271,6 +705,22 @@ TCPSocket *TCPServerSocket::accept() throw(SocketException) {
   return new TCPSocket(newConnSD);
 }
 
+TCPSocket *TCPServerSocket::accept(int timeoutMs) throw(SocketException) {
+  if (!waitReadable(timeoutMs)) {
+    return NULL;
+  }
+  int newConnSD;
+  if ((newConnSD = ::accept(sockDesc, NULL, 0)) < 0) {
+    // the connection may be gone again
+    if (wouldBlock() || (errno == ECONNABORTED)) {
+      return NULL;
+    }
+    throw SocketException("Accept failed (accept())", true);
+  }
+
+  return new TCPSocket(newConnSD);
+}
+
 void TCPServerSocket::setListen(int queueLen) throw(SocketException) {
   if (listen(sockDesc, queueLen) < 0) {
     throw SocketException("Set listening socket failed (listen())", true);
@@ -324,27 +774,35 @@ void UDPSocket::disconnect() throw(SocketException) {
 void UDPSocket::sendTo(const void *buffer, int bufferLen,
     const string &foreignAddress, unsigned short foreignPort)
     throw(SocketException) {
-  sockaddr_in destAddr;
-  fillAddr(foreignAddress, foreignPort, destAddr);
+  sendTo(buffer, bufferLen, SocketAddress(foreignAddress, foreignPort));
+}
+
+void UDPSocket::sendTo(const void *buffer, int bufferLen,
+    const SocketAddress &foreignAddress) throw(SocketException) {
+  if (foreignAddress.getFamily() != family) {
+    useFamily(foreignAddress.getFamily());
+    setBroadcast();
+  }
 
   // Write out the whole buffer as a single message.
   if (sendto(sockDesc, (raw_type *) buffer, bufferLen, 0,
-             (sockaddr *) &destAddr, sizeof(destAddr)) != bufferLen) {
+             foreignAddress.getSockAddr(), foreignAddress.getLength()) != bufferLen) {
     throw SocketException("Send failed (sendto())", true);
   }
 }
 
 int UDPSocket::recvFrom(void *buffer, int bufferLen, string &sourceAddress,
     unsigned short &sourcePort) throw(SocketException) {
-  sockaddr_in clntAddr;
+  sockaddr_storage clntAddr;
   socklen_t addrLen = sizeof(clntAddr);
   int rtn;
   if ((rtn = recvfrom(sockDesc, (raw_type *) buffer, bufferLen, 0,
                       (sockaddr *) &clntAddr, (socklen_t *) &addrLen)) < 0) {
     throw SocketException("Receive failed (recvfrom())", true);
   }
-  sourceAddress = inet_ntoa(clntAddr.sin_addr);
-  sourcePort = ntohs(clntAddr.sin_port);
+  SocketAddress source((sockaddr *) &clntAddr, addrLen);
+  sourceAddress = source.getAddress();
+  sourcePort = source.getPort();
 
   return rtn;
 }
@@ -380,4 +838,70 @@ void UDPSocket::leaveGroup(const string &multicastGroup) throw(SocketException)
   }
 }
 
+#ifdef __linux__
+// SocketPoller Code
+
+SocketPoller::SocketPoller() throw(SocketException) {
+  if ((epollDesc = epoll_create1(0)) < 0) {
+    throw SocketException("Poller creation failed (epoll_create1())", true);
+  }
+}
+
+SocketPoller::~SocketPoller() {
+  ::close(epollDesc);
+}
 
+// epoll events of the arguments of add() and modify()
+static struct epoll_event pollerEvent(int id, bool read, bool write) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = (read ? (EPOLLIN | EPOLLRDHUP) : 0) | (write ? EPOLLOUT : 0);
+  event.data.u32 = (uint32_t) id;
+  return event;
+}
+
+void SocketPoller::add(Socket *socket, int id, bool read, bool write)
+    throw(SocketException) {
+  add(socket->getDescriptor(), id, read, write);
+}
+
+void SocketPoller::add(int descriptor, int id, bool read, bool write)
+    throw(SocketException) {
+  struct epoll_event event = pollerEvent(id, read, write);
+  if (epoll_ctl(epollDesc, EPOLL_CTL_ADD, descriptor, &event) < 0) {
+    throw SocketException("Add to poller failed (epoll_ctl())", true);
+  }
+}
+
+void SocketPoller::modify(int descriptor, int id, bool read, bool write)
+    throw(SocketException) {
+  struct epoll_event event = pollerEvent(id, read, write);
+  if (epoll_ctl(epollDesc, EPOLL_CTL_MOD, descriptor, &event) < 0) {
+    throw SocketException("Modify of poller failed (epoll_ctl())", true);
+  }
+}
+
+void SocketPoller::remove(int descriptor) {
+  struct epoll_event event;    // not used, but not NULL for old kernels
+  epoll_ctl(epollDesc, EPOLL_CTL_DEL, descriptor, &event);
+}
+
+int SocketPoller::wait(Event *events, int maxEvents, int timeoutMs)
+    throw(SocketException) {
+  vector<struct epoll_event> ready(maxEvents);
+  int n = epoll_wait(epollDesc, &ready[0], maxEvents, timeoutMs);
+  if (n < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    throw SocketException("Wait of poller failed (epoll_wait())", true);
+  }
+  for (int k = 0; k < n; k++) {
+    events[k].id       = (int) ready[k].data.u32;
+    events[k].readable = (ready[k].events & EPOLLIN) != 0;
+    events[k].writable = (ready[k].events & EPOLLOUT) != 0;
+    events[k].hangup   = (ready[k].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) != 0;
+  }
+  return n;
+}
+#endif
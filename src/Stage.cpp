@@ -0,0 +1,85 @@
+/*
+ * Stage.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/Stage.H"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
+
+
+Stage::Stage(int width, int height){
+	width_      = width;
+	height_     = height;
+	output_     = NULL;
+	outputSize_ = 0;
+	seq_        = 0;
+	timeStamp_  = 0;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&processedCond_, NULL);
+}
+
+
+Stage::~Stage(){
+	delete [] output_;
+	pthread_cond_destroy(&processedCond_);
+	pthread_mutex_destroy(&mutex_);
+}
+
+
+void Stage::allocOutput(int size){
+	delete [] output_;
+	output_     = new unsigned char[size];
+	outputSize_ = size;
+	memset(output_, 0, size);
+}
+
+
+void Stage::processed(){
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	timeStamp_ = ((uint64_t) t.tv_sec) * 1000000 + t.tv_usec;
+	seq_++;
+	pthread_cond_broadcast(&processedCond_);
+}
+
+
+void Stage::waitProcessed(unsigned long seq){
+	while(seq_ == seq){
+		pthread_cond_wait(&processedCond_, &mutex_);
+	};
+}
+
+
+bool Stage::waitProcessed(unsigned long seq, int timeoutMs){
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	long long ns = ((long long) now.tv_usec) * 1000 + ((long long) timeoutMs) * 1000000;
+	struct timespec deadline;
+	deadline.tv_sec  = now.tv_sec + (time_t) (ns / 1000000000);
+	deadline.tv_nsec = (long) (ns % 1000000000);
+
+	int rtn = 0;
+	while((seq_ == seq) && (rtn == 0)){
+		rtn = pthread_cond_timedwait(&processedCond_, &mutex_, &deadline);
+	};
+	return (seq_ != seq);
+}
+
+
+InputStage::InputStage(int width, int height, int color, int reserve) : Stage(width, height){
+	color_ = color;
+	allocOutput(((color > 0) ? 3 : 1) * width * height + reserve);
+	outputSize_ -= reserve;
+}
+
+
+string InputStage::metaData(){
+	char meta[124];
+	sprintf(meta, "[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
+			width_, height_, 'W', color_, 'R', 'G', 'B', outputSize_, 0);
+	return string(meta);
+}
@@ -0,0 +1,175 @@
+/*
+ * StageServer.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/StageServer.H"
+#include "../include/StdImgDataServerProtocol.H"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/uio.h>
+
+
+// a client and its server, handed over to the thread of the client
+struct StageClient{
+	StageServer *server;
+	TCPSocket   *sock;
+};
+
+
+StageServer::StageServer(unsigned short port){
+	server_ = new TCPServerSocket(port);
+	stage_  = NULL;
+}
+
+
+void StageServer::start(Stage *stage){
+	stage_ = stage;
+	pthread_create(&thread_, NULL, runServer, this);
+}
+
+
+void *StageServer::runServer(void *server){
+	StageServer *s = (StageServer *) server;
+	try{
+		do{   // Run forever
+			StageClient *client = new StageClient;
+			client->server = s;
+			client->sock   = s->server_->accept();       // Wait for a client to connect
+			pthread_t thread;
+			if(pthread_create(&thread, NULL, runClient, client) != 0){
+				cerr << "Can't start the thread of a client" << endl;
+				delete client->sock;
+				delete client;
+				continue;
+			};
+			pthread_detach(thread);
+		}while(true);
+	}catch (SocketException &e) {
+		cerr << e.what() << endl;
+	};
+	return NULL;
+}
+
+
+void *StageServer::runClient(void *client){
+	StageClient *c = (StageClient *) client;
+	c->server->handleClient(c->sock);
+	delete c;
+	return NULL;
+}
+
+
+void StageServer::handleClient(TCPSocket *sock){
+  cout << "Handling central unit\n";
+  try {
+    cout << sock->getForeignAddress() << ":";
+  } catch (SocketException &e) {
+    cerr << "Unable to get foreign address" << endl;
+  }
+  try {
+    cout << sock->getForeignPort();
+  } catch (SocketException &e) {
+    cerr << "Unable to get foreign port" << endl;
+  }
+  cout << endl;
+  // Send received string and receive again until the end of transmission
+  int revBUFFER_SIZE = 1024;
+
+  char revBuffer[revBUFFER_SIZE + 1];
+  int recvMsgSize;
+
+  char echoMetaData[124];
+  string reply;
+  vector<unsigned char> frame(stage_->outputSize());
+
+  do{
+    try{
+    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
+    	if(recvMsgSize < 1) break;
+    	revBuffer[recvMsgSize] = '\0';
+
+    	if(!(strncmp(GET_META_DATA,revBuffer,strlen(GET_META_DATA)))){
+    		reply = stage_->metaData();
+    		sock->send(reply.c_str(), reply.length());
+    	}else if(!(strncmp(GET_IMAGE_DATA,revBuffer,strlen(GET_IMAGE_DATA)))){
+    		// a copy of the last processed frame
+    		stage_->lock();
+    		memcpy(&frame[0], stage_->output(), frame.size());
+    		stage_->unlock();
+    		sock->send(&frame[0], frame.size());
+    	}else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
+    		echoMetaData[0]='\0';
+    		sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
+    		sock->send(echoMetaData,strlen(echoMetaData));
+    	}else if(!(strncmp(SET_PARAM,revBuffer,strlen(SET_PARAM)))){
+    		reply = stage_->params().set(revBuffer + strlen(SET_PARAM));
+    		sock->send(reply.c_str(), reply.length());
+    	}else if(!(strncmp(GET_PARAM,revBuffer,strlen(GET_PARAM)))){
+    		reply = stage_->params().get(revBuffer + strlen(GET_PARAM));
+    		sock->send(reply.c_str(), reply.length());
+    	}else if(!(strncmp(SUBSCRIBE,revBuffer,strlen(SUBSCRIBE)))){
+    		// until the client closes the connection
+    		pushFrames(sock);
+    		break;
+    	}else{
+    		stage_->lock();
+    		bool known = stage_->command(revBuffer, &reply);
+    		stage_->unlock();
+    		if(!known){
+    			// send protocol
+    			reply = string(UNKNOWN_COMMAND) + " please try:\n " + GET_VERSION + "\n " + GET_META_DATA + "\n "
+    					+ GET_IMAGE_DATA + "\n" + stage_->commands() + " " + SET_PARAM + "\n " + GET_PARAM + "\n "
+    					+ SUBSCRIBE + "\n";
+    		};
+    		sock->send(reply.c_str(), reply.length());
+    	};
+    }catch(...){
+    	break;
+    };
+  }while(true);
+
+  delete sock;
+}
+
+
+void StageServer::pushFrames(TCPSocket *sock){
+	unsigned char header[SUBSCRIBE_HEADER_SIZE];
+	vector<unsigned char> frame(stage_->outputSize());
+	unsigned long seq = 0;
+
+	// header and frame by one system call
+	struct iovec message[2];
+	message[0].iov_base = header;
+	message[0].iov_len  = SUBSCRIBE_HEADER_SIZE;
+	message[1].iov_base = &frame[0];
+	message[1].iov_len  = frame.size();
+
+	stage_->lock();
+	seq = stage_->seq();
+	stage_->unlock();
+
+	try{
+		do{
+			uint64_t timeStamp;
+			stage_->lock();
+			stage_->waitProcessed(seq);
+			seq       = stage_->seq();
+			timeStamp = stage_->timeStamp();
+			memcpy(&frame[0], stage_->output(), frame.size());
+			stage_->unlock();
+
+			for(int k = 0; k < 8; k++){
+				header[k]     = (unsigned char) (((uint64_t) seq) >> (8*k));
+				header[8 + k] = (unsigned char) (timeStamp >> (8*k));
+			};
+			sock->sendv(message, 2);
+		}while(true);
+	}catch(SocketException &e){
+		// the client closed the connection
+	};
+}
@@ -0,0 +1,311 @@
+/*
+ * StdImgClient.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/StdImgClient.H"
+#include "../include/Socket.H"
+#include "../include/StdImgDataServerProtocol.H"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/uio.h>
+
+
+#define RECONNECT_DELAY_MS 500
+// replies without a closing bracket (GET_VERSION) are received at once
+#define TEXT_BUFFER_SIZE 1024
+
+
+bool parseMetaData(const char *text, StdImgMetaData *meta){
+	int nmbTokens = sscanf(text, "[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
+			&meta->width, &meta->height, &meta->org, &meta->color,
+			&meta->format[0], &meta->format[1], &meta->format[2], &meta->imageSize, &meta->timeStampSize);
+	meta->format[3] = '\0';
+	return (nmbTokens == 9);
+}
+
+
+StdImgClient::StdImgClient(const string &host, unsigned short port, int reconnects){
+	host_       = host;
+	port_       = port;
+	reconnects_ = reconnects;
+	socket_     = NULL;
+	subscribed_ = false;
+	closing_    = false;
+
+	buffers_[0] = NULL;
+	buffers_[1] = NULL;
+	ready_      = -1;
+	held_       = -1;
+	seq_        = 0;
+	taken_      = 0;
+	lost_       = false;
+	stop_       = false;
+	started_    = false;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&changed_, NULL);
+
+	connect();
+}
+
+
+StdImgClient::~StdImgClient(){
+	if(started_){
+		pthread_mutex_lock(&mutex_);
+		stop_ = true;
+		pthread_cond_broadcast(&changed_);
+		pthread_mutex_unlock(&mutex_);
+		pthread_join(thread_, NULL);
+	};
+	delete socket_;
+	delete [] buffers_[0];
+	delete [] buffers_[1];
+	pthread_cond_destroy(&changed_);
+	pthread_mutex_destroy(&mutex_);
+}
+
+
+void StdImgClient::connect(){
+	TCPSocket *sock = NULL;
+	try{
+		// a server that hangs counts as lost, the reconnection renews it
+		sock = new TCPSocket();
+		sock->setTimeout(STDIMGCLIENT_TIMEOUT_MS);
+		sock->connect(host_, port_);
+	}catch(SocketException &e){
+		delete sock;
+		throw string("No server for image data: ") + host_ + "\n" + e.what();
+	};
+	// shutdown() may be called by another thread
+	pthread_mutex_lock(&mutex_);
+	socket_ = sock;
+	bool closing = closing_;
+	pthread_mutex_unlock(&mutex_);
+	if(closing){
+		throw string("connection shut down");
+	};
+
+	version_  = receiveText(GET_VERSION, false);
+	metaText_ = receiveText(GET_META_DATA, true);
+	if(!parseMetaData(metaText_.c_str(), &meta_)){
+		throw string("Can't interpret image meta data: ") + metaText_;
+	};
+	if(subscribed_){
+		try{
+			socket_->send(SUBSCRIBE, strlen(SUBSCRIBE));
+		}catch(SocketException &e){
+			throw string(e.what());
+		};
+		// pushed frames come at the rate of the server
+		socket_->setTimeout(-1);
+	};
+}
+
+
+void StdImgClient::dropSocket(){
+	pthread_mutex_lock(&mutex_);
+	delete socket_;
+	socket_ = NULL;
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+void StdImgClient::shutdown(){
+	pthread_mutex_lock(&mutex_);
+	closing_ = true;
+	if(socket_ != NULL){
+		socket_->shutdown();
+	};
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+bool StdImgClient::reconnect(){
+	StdImgMetaData before     = meta_;
+	string         beforeText = metaText_;
+	for(int k = 0; ((reconnects_ < 0) || (k < reconnects_)) && !closing_; k++){
+		dropSocket();
+		usleep(1000 * RECONNECT_DELAY_MS);
+		try{
+			connect();
+		}catch(string msg){
+			continue;
+		};
+		// the buffers of the caller are sized for the old frames, a server
+		// with other meta data is not used
+		if((meta_.frameSize() == before.frameSize()) && (meta_.width == before.width)
+				&& (meta_.height == before.height) && (meta_.color == before.color)){
+			return true;
+		};
+		dropSocket();
+		meta_     = before;
+		metaText_ = beforeText;
+		return false;
+	};
+	dropSocket();
+	meta_     = before;
+	metaText_ = beforeText;
+	return false;
+}
+
+
+string StdImgClient::receiveText(const char *command, bool bracket){
+	if(socket_ == NULL){
+		throw string("not connected");
+	};
+
+	string text;
+	char buffer[TEXT_BUFFER_SIZE];
+	try{
+		socket_->send(command, strlen(command));
+		do{
+			int bytesReceived = socket_->recv(buffer, sizeof(buffer) - 1);
+			if(bytesReceived <= 0){
+				throw string("Connection closed while receiving the reply to ") + command;
+			};
+			buffer[bytesReceived] = '\0';
+			text += string(buffer);
+		}while(bracket && (text.find(']') == string::npos));
+	}catch(SocketException &e){
+		throw string(e.what());
+	};
+	return text;
+}
+
+
+string StdImgClient::request(const char *command){
+	return receiveText(command, true);
+}
+
+
+bool StdImgClient::receive(unsigned char *frame){
+	do{
+		if(socket_ != NULL){
+			try{
+				socket_->send(GET_IMAGE_DATA, strlen(GET_IMAGE_DATA));
+				if(socket_->recvAll(frame, frameSize()) == frameSize()){
+					return true;
+				};
+			}catch(SocketException &e){
+			};
+		};
+	}while(reconnect());
+	return false;
+}
+
+
+void StdImgClient::startReceiving(){
+	if(started_){
+		return;
+	};
+	buffers_[0] = new unsigned char[frameSize()];
+	buffers_[1] = new unsigned char[frameSize()];
+	started_ = true;
+	pthread_create(&thread_, NULL, runReceiver, this);
+}
+
+
+void *StdImgClient::runReceiver(void *client){
+	((StdImgClient *) client)->receiveLoop();
+	return NULL;
+}
+
+
+void StdImgClient::receiveLoop(){
+	int target = 0;
+	while(true){
+		// the buffer being processed is not overwritten
+		pthread_mutex_lock(&mutex_);
+		while((held_ == target) && !stop_){
+			pthread_cond_wait(&changed_, &mutex_);
+		};
+		bool stop = stop_;
+		pthread_mutex_unlock(&mutex_);
+		if(stop){
+			break;
+		};
+
+		bool received = receive(buffers_[target]);
+
+		pthread_mutex_lock(&mutex_);
+		if(received){
+			ready_ = target;
+			seq_++;
+		}else{
+			lost_ = true;
+		};
+		pthread_cond_broadcast(&changed_);
+		pthread_mutex_unlock(&mutex_);
+		if(!received){
+			break;
+		};
+		target = 1 - target;
+	};
+}
+
+
+const unsigned char *StdImgClient::nextFrame(){
+	pthread_mutex_lock(&mutex_);
+	held_ = -1;
+	pthread_cond_broadcast(&changed_);
+	while((seq_ == taken_) && !lost_){
+		pthread_cond_wait(&changed_, &mutex_);
+	};
+	if(seq_ == taken_){
+		pthread_mutex_unlock(&mutex_);
+		return NULL;
+	};
+	held_  = ready_;
+	taken_ = seq_;
+	pthread_mutex_unlock(&mutex_);
+	return buffers_[held_];
+}
+
+
+void StdImgClient::subscribe(){
+	if(subscribed_){
+		return;
+	};
+	subscribed_ = true;
+	if(socket_ != NULL){
+		try{
+			socket_->send(SUBSCRIBE, strlen(SUBSCRIBE));
+			socket_->setTimeout(-1);
+		}catch(SocketException &e){
+			// renewed by the reconnection of receivePushed()
+		};
+	};
+}
+
+
+bool StdImgClient::receivePushed(unsigned char *frame, unsigned long *seq, uint64_t *timeStamp){
+	unsigned char header[SUBSCRIBE_HEADER_SIZE];
+	// header and frame by one system call
+	struct iovec message[2];
+	message[0].iov_base = header;
+	message[0].iov_len  = SUBSCRIBE_HEADER_SIZE;
+	message[1].iov_base = frame;
+	message[1].iov_len  = frameSize();
+	do{
+		if(socket_ != NULL){
+			try{
+				if(socket_->recvv(message, 2) == SUBSCRIBE_HEADER_SIZE + frameSize()){
+					uint64_t s = 0;
+					uint64_t t = 0;
+					for(int k = 7; k >= 0; k--){
+						s = (s << 8) | header[k];
+						t = (t << 8) | header[8 + k];
+					};
+					*seq       = (unsigned long) s;
+					*timeStamp = t;
+					return true;
+				};
+			}catch(SocketException &e){
+			};
+		};
+	}while(reconnect());
+	return false;
+}
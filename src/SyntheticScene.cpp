@@ -0,0 +1,144 @@
+/*
+ * SyntheticScene.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/SyntheticScene.H"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+
+// background and disc colours
+static const unsigned char BACKGROUND_ = 40;
+static const unsigned char DISC_COLORS_[3][3] = {
+		{220,  40,  40},   // red
+		{ 40, 220,  40},   // green
+		{ 40,  40, 220}    // blue
+};
+static const unsigned char DISC_GREY_ = 220;
+
+
+SyntheticScene::SyntheticScene(int width, int height, int color,
+		int nmbDiscs, int radius, double speed, int noise, unsigned long long seed){
+	width_  = width;
+	height_ = height;
+	color_  = color;
+	noise_  = (noise < 0) ? 0 : ((noise > 127) ? 127 : noise);
+
+	// discs have to fit into the image
+	int maxRadius = ((width < height) ? width : height) / 2 - 1;
+	if(radius > maxRadius) radius = maxRadius;
+	if(radius < 1) radius = 1;
+
+	ImgKernels::randomSeed(&random_, seed);
+	unsigned int rnd[4];
+	for(int k = 0; k < nmbDiscs; k++){
+		ImgKernels::randomFillFast(&random_, (char *) rnd, sizeof(rnd));
+
+		SceneDisc d;
+		d.radius = radius;
+		d.x  = radius + (rnd[0] % (unsigned int) (width  - 2*radius));
+		d.y  = radius + (rnd[1] % (unsigned int) (height - 2*radius));
+		double angle = (2.0 * M_PI * (rnd[2] % 3600)) / 3600.0;
+		d.vx = speed * cos(angle);
+		d.vy = speed * sin(angle);
+		if(color_ != 0){
+			d.r = DISC_COLORS_[k % 3][0];
+			d.g = DISC_COLORS_[k % 3][1];
+			d.b = DISC_COLORS_[k % 3][2];
+		}else{
+			d.r = d.g = d.b = DISC_GREY_;
+		};
+		discs_.push_back(d);
+	};
+
+	noiseRow_.resize(width * 3 + 64);
+}
+
+
+void SyntheticScene::step(){
+	for(size_t k = 0; k < discs_.size(); k++){
+		SceneDisc &d = discs_[k];
+		d.x += d.vx;
+		d.y += d.vy;
+
+		// bounce off the borders
+		if(d.x < d.radius){
+			d.x  = 2*d.radius - d.x;
+			d.vx = -d.vx;
+		}else if(d.x > width_ - 1 - d.radius){
+			d.x  = 2*(width_ - 1 - d.radius) - d.x;
+			d.vx = -d.vx;
+		};
+		if(d.y < d.radius){
+			d.y  = 2*d.radius - d.y;
+			d.vy = -d.vy;
+		}else if(d.y > height_ - 1 - d.radius){
+			d.y  = 2*(height_ - 1 - d.radius) - d.y;
+			d.vy = -d.vy;
+		};
+	};
+}
+
+
+void SyntheticScene::render(char *imageData){
+	int channels = (color_ != 0) ? 3 : 1;
+	int rowSize  = width_ * channels;
+	unsigned char *data = (unsigned char *) imageData;
+
+	memset(data, BACKGROUND_, rowSize * height_);
+
+	// discs, rounded to the pixel grid; a disc centred at (x,y) covers
+	// the pixels with (i-x)^2 + (j-y)^2 <= r^2
+	for(size_t k = 0; k < discs_.size(); k++){
+		const SceneDisc &d = discs_[k];
+		int cx = (int) floor(d.x + 0.5);
+		int cy = (int) floor(d.y + 0.5);
+		for(int dy = -d.radius; dy <= d.radius; dy++){
+			int y = cy + dy;
+			if((y < 0) || (y >= height_)) continue;
+			int dx = (int) sqrt((double) (d.radius*d.radius - dy*dy));
+			int x0 = (cx - dx < 0) ? 0 : cx - dx;
+			int x1 = (cx + dx >= width_) ? width_ - 1 : cx + dx;
+			unsigned char *row = data + y*rowSize;
+			if(channels == 3){
+				for(int x = x0; x <= x1; x++){
+					row[3*x + 0] = d.r;
+					row[3*x + 1] = d.g;
+					row[3*x + 2] = d.b;
+				};
+			}else{
+				memset(row + x0, d.r, x1 - x0 + 1);
+			};
+		};
+	};
+
+	// additive noise in [-noise, noise] on every byte
+	if(noise_ > 0){
+		int range = 2*noise_ + 1;
+		for(int y = 0; y < height_; y++){
+			ImgKernels::randomFillFast(&random_, (char *) &noiseRow_[0], rowSize);
+			unsigned char *row = data + y*rowSize;
+			for(int i = 0; i < rowSize; i++){
+				int v = row[i] + ((noiseRow_[i] * range) >> 8) - noise_;
+				row[i] = (v < 0) ? 0 : ((v > 255) ? 255 : v);
+			};
+		};
+	};
+}
+
+
+int SyntheticScene::groundTruth(char *buffer, int bufferSize){
+	int n = snprintf(buffer, bufferSize, "N=%d", (int) discs_.size());
+	for(size_t k = 0; (k < discs_.size()) && (n < bufferSize); k++){
+		// centre of the rendered disc
+		n += snprintf(buffer + n, bufferSize - n, ",%d:%d:%d",
+				(int) floor(discs_[k].x + 0.5), (int) floor(discs_[k].y + 0.5), discs_[k].radius);
+	};
+	return (n < bufferSize) ? n : bufferSize - 1;
+}
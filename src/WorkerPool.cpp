@@ -0,0 +1,172 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "../include/WorkerPool.H"
+
+#include <unistd.h>
+
+
+static inline uint64_t packRange(uint32_t begin, uint32_t end){
+	return ((uint64_t) end << 32) | begin;
+}
+
+static inline uint32_t rangeBegin(uint64_t r){ return (uint32_t) r; }
+static inline uint32_t rangeEnd(uint64_t r){ return (uint32_t) (r >> 32); }
+
+
+WorkerPool::WorkerPool(int nmbThreads){
+	if(nmbThreads < 1){
+		nmbThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	};
+	nmbThreads_ = (nmbThreads < 1) ? 1 : nmbThreads;
+	ranges_     = new Range[nmbThreads_];
+	for(int w = 0; w < nmbThreads_; w++){
+		ranges_[w].bands = 0;
+	};
+
+	generation_ = 0;
+	running_    = 0;
+	stop_       = false;
+	task_       = NULL;
+	arg_        = NULL;
+	stolen_     = 0;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&start_, NULL);
+	pthread_cond_init(&done_, NULL);
+
+	// worker 0 is the thread calling run()
+	threads_.resize(nmbThreads_ - 1);
+	starts_.resize(nmbThreads_ - 1);
+	for(size_t t = 0; t < threads_.size(); t++){
+		starts_[t].pool   = this;
+		starts_[t].worker = (int) t + 1;
+		pthread_create(&threads_[t], NULL, runWorker, &starts_[t]);
+	};
+}
+
+
+WorkerPool::~WorkerPool(){
+	pthread_mutex_lock(&mutex_);
+	stop_ = true;
+	pthread_cond_broadcast(&start_);
+	pthread_mutex_unlock(&mutex_);
+
+	for(size_t t = 0; t < threads_.size(); t++){
+		pthread_join(threads_[t], NULL);
+	};
+	pthread_cond_destroy(&done_);
+	pthread_cond_destroy(&start_);
+	pthread_mutex_destroy(&mutex_);
+	delete [] ranges_;
+}
+
+
+void WorkerPool::run(int nmbBands, void (*task)(int band, void *arg), void *arg){
+	if(nmbBands < 1){
+		return;
+	};
+	if(nmbThreads_ == 1){
+		for(int band = 0; band < nmbBands; band++){
+			task(band, arg);
+		};
+		return;
+	};
+
+	for(int w = 0; w < nmbThreads_; w++){
+		ranges_[w].bands = packRange(bandBegin(w, nmbThreads_, nmbBands), bandBegin(w + 1, nmbThreads_, nmbBands));
+	};
+
+	pthread_mutex_lock(&mutex_);
+	task_    = task;
+	arg_     = arg;
+	running_ = nmbThreads_ - 1;
+	generation_++;
+	pthread_cond_broadcast(&start_);
+	pthread_mutex_unlock(&mutex_);
+
+	work(0);
+
+	// the workers may still execute bands stolen from us
+	pthread_mutex_lock(&mutex_);
+	while(running_ > 0){
+		pthread_cond_wait(&done_, &mutex_);
+	};
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+void *WorkerPool::runWorker(void *start){
+	Start *s = (Start *) start;
+	s->pool->workLoop(s->worker);
+	return NULL;
+}
+
+
+void WorkerPool::workLoop(int worker){
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&mutex_);
+	for(;;){
+		while(!stop_ && (generation_ == seen)){
+			pthread_cond_wait(&start_, &mutex_);
+		};
+		if(stop_){
+			break;
+		};
+		seen = generation_;
+		pthread_mutex_unlock(&mutex_);
+
+		work(worker);
+
+		pthread_mutex_lock(&mutex_);
+		if(--running_ == 0){
+			pthread_cond_signal(&done_);
+		};
+	};
+	pthread_mutex_unlock(&mutex_);
+}
+
+
+void WorkerPool::work(int worker){
+	int band;
+	while(takeOwn(worker, &band)){
+		task_(band, arg_);
+	};
+	while(steal(worker, &band)){
+		task_(band, arg_);
+		stolen_++;
+	};
+}
+
+
+bool WorkerPool::takeOwn(int worker, int *band){
+	std::atomic<uint64_t> &bands = ranges_[worker].bands;
+	uint64_t r = bands;
+	while(rangeBegin(r) < rangeEnd(r)){
+		if(bands.compare_exchange_weak(r, packRange(rangeBegin(r) + 1, rangeEnd(r)))){
+			*band = rangeBegin(r);
+			return true;
+		};
+	};
+	return false;
+}
+
+
+bool WorkerPool::steal(int worker, int *band){
+	// victims in a fixed order starting behind the thief; a range only
+	// shrinks during a run, an empty range stays empty
+	for(int k = 1; k < nmbThreads_; k++){
+		std::atomic<uint64_t> &bands = ranges_[(worker + k) % nmbThreads_].bands;
+		uint64_t r = bands;
+		while(rangeBegin(r) < rangeEnd(r)){
+			if(bands.compare_exchange_weak(r, packRange(rangeBegin(r), rangeEnd(r) - 1))){
+				*band = rangeEnd(r) - 1;
+				return true;
+			};
+		};
+	};
+	return false;
+}
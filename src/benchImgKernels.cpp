@@ -0,0 +1,1025 @@
+/*
+    This program measures the per-pixel kernels of the standard
+    image data servers and clients on synthetic frames.
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ *
+ * \file benchImgKernels.cpp
+ *
+ * \brief Runs every kernel of ImgKernels on synthetic frames of
+ * 640x480, 1280x720 and 1920x1080 pixels, reports ns/pixel and GB/s
+ * and compares the results with a stored baseline.
+ *
+ * Baseline files contain one line per measurement:
+ *
+ *     <kernel> <width>x<height> <ns/pixel>
+ *
+ * A measurement slower than the baseline by more than the tolerance
+ * is measured again at the end, up to RECHECKS_ times on freshly
+ * allocated buffers: the other kernels and the placement of the
+ * buffers change a single measurement by more than the tolerance.
+ * Only if it stays slower it is flagged as REGRESSION and the program
+ * returns 1, with -report 0: the speed of a shared or virtual machine
+ * varies from run to run by more than any tolerance.
+ *
+ * The swizzle kernels and the color filter run with the variant
+ * selected at start up and once more with every instruction set
+ * variant supported by the CPU (<kernel>.<variant>).
+ *
+ * With -check nothing is measured: every variant of a kernel runs on
+ * frames of odd sizes and its bytes (or blob scan) are compared with
+ * those of the scalar variant, the window and pyramid blob scans and
+ * the blob labeler with naive per pixel loops, the color filter with
+ * random parameters with the float formula it replaced (the sum within
+ * one grey level), with its lookup table variant and, fused with the
+ * blob scan, with the blob scan of its sum.  The program returns 1 on any mismatch.
+ *
+ */
+
+
+#include <iostream>           // For cerr and cout
+#include <cstdlib>            // For atoi()
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+
+#include "../include/ImgKernels.H"
+#include "../include/MaxPyramid.H"
+#include "../include/BlobLabeler.H"
+#include "../include/WorkerPool.H"
+
+using namespace std;
+
+
+struct Frame{
+	int width;
+	int height;
+};
+
+// the frames are allocated once per resolution and shared by all kernels
+struct Buffers{
+	unsigned char *rgb;      // packed RGB source
+	unsigned char *bgr;      // 3 channel destination (IplImage layout)
+	unsigned char *grey;     // packed grey source
+	unsigned char *planes;   // 4 one channel destinations of the color filter
+	unsigned char *sum;      // packed grey destination
+	int            bgrStep;
+	int            planeStep;
+
+	ImgKernels::BlobScanResult scan;   // result of the scan kernels
+};
+
+// a kernel run on one frame, returns the number of bytes read and written
+typedef double (*KernelRun)(const Frame &f, Buffers &b);
+
+struct Kernel{
+	const char *name;
+	KernelRun   run;
+	int         variant;   // -1: variant selected at start up
+};
+
+// a measurement slower than the baseline, measured again at the end
+struct Suspect{
+	int    kernel;
+	int    frame;
+	double limit;    // ns/pixel
+};
+
+
+double runBgrToRgb(const Frame &f, Buffers &b){
+	ImgKernels::bgrToRgb(b.bgr, b.bgrStep, 3, b.rgb, f.width, f.height);
+	return 6.0 * f.width * f.height;
+}
+
+double runRgbToBgr(const Frame &f, Buffers &b){
+	ImgKernels::rgbToBgr(b.rgb, b.bgr, b.bgrStep, 3, f.width, f.height);
+	return 6.0 * f.width * f.height;
+}
+
+double runGreyToPlane(const Frame &f, Buffers &b){
+	ImgKernels::greyToPlane(b.grey, b.planes, b.planeStep, f.width, f.height);
+	return 2.0 * f.width * f.height;
+}
+
+double runGreyToBgr(const Frame &f, Buffers &b){
+	ImgKernels::greyToBgr(b.grey, b.bgr, b.bgrStep, 3, f.width, f.height);
+	return 4.0 * f.width * f.height;
+}
+
+double runBgrToGrey(const Frame &f, Buffers &b){
+	ImgKernels::bgrToGrey(b.bgr, b.bgrStep, 3, b.sum, f.width, f.height);
+	return 4.0 * f.width * f.height;
+}
+
+double runColorFilter(const Frame &f, Buffers &b){
+	// default parameters of stdImgDataServerClientColorFilter with all parts in use
+	ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+	int planeSize = b.planeStep * f.height;
+	ImgKernels::colorFilter(b.rgb, f.width, f.height, p,
+			b.planes, b.planes + planeSize, b.planes + 2*planeSize, b.planes + 3*planeSize, b.planeStep, b.sum);
+	return 8.0 * f.width * f.height;
+}
+
+double runColorFilterSum(const Frame &f, Buffers &b){
+	// prepared once as the client does, no filter images
+	static ImgKernels::ColorFilterPrepared prepared;
+	static bool done = false;
+	if(!done){
+		ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+		ImgKernels::prepareColorFilter(p, &prepared);
+		done = true;
+	};
+	ImgKernels::colorFilter(b.rgb, f.width, f.height, prepared, NULL, NULL, NULL, NULL, 0, b.sum);
+	return 4.0 * f.width * f.height;
+}
+
+double runColorFilterLut(const Frame &f, Buffers &b){
+	static ImgKernels::ColorFilterPrepared prepared;
+	static bool done = false;
+	if(!done){
+		ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+		ImgKernels::prepareColorFilter(p, &prepared);
+		done = true;
+	};
+	ImgKernels::colorFilterLut(b.rgb, f.width, f.height, prepared, NULL, NULL, NULL, NULL, 0, b.sum);
+	return 4.0 * f.width * f.height;
+}
+
+double runClassifyColors(const Frame &f, Buffers &b){
+	// eight target colors, costs the same as one
+	static ImgKernels::ColorClassLut lut;
+	static bool done = false;
+	if(!done){
+		ImgKernels::ColorClass classes[COLOR_CLASSES_MAX];
+		for(int k = 0; k < COLOR_CLASSES_MAX; k++){
+			classes[k].minR = 30*k; classes[k].maxR = 30*k + 60;
+			classes[k].minG = 0;    classes[k].maxG = 255 - 30*k;
+			classes[k].minB = 20*k; classes[k].maxB = 200;
+		};
+		ImgKernels::buildColorClassLut(classes, COLOR_CLASSES_MAX, &lut);
+		done = true;
+	};
+	ImgKernels::classifyColors(b.rgb, f.width, f.height, lut, b.sum);
+	return 4.0 * f.width * f.height;
+}
+
+double runBlobScan(const Frame &f, Buffers &b){
+	ImgKernels::blobScan(b.grey, f.width, f.height, 128, &b.scan);
+	return 1.0 * f.width * f.height;
+}
+
+double runColorFilterBlobScan(const Frame &f, Buffers &b){
+	// the sum written by the filter and read again by the scan
+	static ImgKernels::ColorFilterPrepared prepared;
+	static bool done = false;
+	if(!done){
+		ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+		ImgKernels::prepareColorFilter(p, &prepared);
+		done = true;
+	};
+	ImgKernels::colorFilter(b.rgb, f.width, f.height, prepared, NULL, NULL, NULL, NULL, 0, b.sum);
+	ImgKernels::blobScan(b.sum, f.width, f.height, 128, &b.scan);
+	return 5.0 * f.width * f.height;
+}
+
+double runColorBlobScan(const Frame &f, Buffers &b){
+	// the same fused into one pass
+	static ImgKernels::ColorFilterPrepared prepared;
+	static bool done = false;
+	if(!done){
+		ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+		ImgKernels::prepareColorFilter(p, &prepared);
+		done = true;
+	};
+	ImgKernels::colorBlobScan(b.rgb, f.width, f.height, prepared, 128, &b.scan);
+	return 3.0 * f.width * f.height;
+}
+
+double runMaxPool2(const Frame &f, Buffers &b){
+	ImgKernels::maxPool2(b.grey, f.width, f.height, b.sum);
+	return 1.25 * f.width * f.height;
+}
+
+double runBlobScanPyramid(const Frame &f, Buffers &b){
+	// build and coarse-to-fine search, the square covers a few blocks
+	static MaxPyramid pyramid(4);
+	pyramid.build(b.grey, f.width, f.height);
+	pyramid.blobScan(128, &b.scan);
+	return 1.33 * f.width * f.height;
+}
+
+double runRandomFill(const Frame &f, Buffers &b){
+	ImgKernels::randomFill((char *) b.rgb, 3 * f.width * f.height);
+	return 3.0 * f.width * f.height;
+}
+
+double runRandomFillFast(const Frame &f, Buffers &b){
+	static ImgKernels::RandomState state;
+	static bool seeded = false;
+	if(!seeded){
+		ImgKernels::randomSeed(&state, 4711);
+		seeded = true;
+	};
+	ImgKernels::randomFillFast(&state, (char *) b.rgb, 3 * f.width * f.height);
+	return 3.0 * f.width * f.height;
+}
+
+#define VARIANT_KERNEL(name, run) \
+		{name,           run, -1}, \
+		{name ".scalar", run, ImgKernels::VARIANT_SCALAR}, \
+		{name ".ssse3",  run, ImgKernels::VARIANT_SSSE3}, \
+		{name ".avx2",   run, ImgKernels::VARIANT_AVX2}, \
+		{name ".avx512", run, ImgKernels::VARIANT_AVX512}
+
+const Kernel KERNELS_[] = {
+		VARIANT_KERNEL("bgrToRgb",  runBgrToRgb),
+		VARIANT_KERNEL("rgbToBgr",  runRgbToBgr),
+		{"greyToPlane", runGreyToPlane, -1},
+		VARIANT_KERNEL("greyToBgr", runGreyToBgr),
+		VARIANT_KERNEL("bgrToGrey", runBgrToGrey),
+		VARIANT_KERNEL("colorFilter", runColorFilter),
+		VARIANT_KERNEL("colorFilterSum", runColorFilterSum),
+		VARIANT_KERNEL("colorFilterLut", runColorFilterLut),
+		VARIANT_KERNEL("classifyColors", runClassifyColors),
+		VARIANT_KERNEL("blobScan",  runBlobScan),
+		VARIANT_KERNEL("colorFilterBlobScan", runColorFilterBlobScan),
+		VARIANT_KERNEL("colorBlobScan", runColorBlobScan),
+		VARIANT_KERNEL("maxPool2",  runMaxPool2),
+		VARIANT_KERNEL("blobScanPyramid", runBlobScanPyramid),
+		{"randomFill",  runRandomFill, -1},
+		{"randomFillFast", runRandomFillFast, -1}
+};
+const int NMB_KERNELS_ = sizeof(KERNELS_) / sizeof(KERNELS_[0]);
+
+const Frame FRAMES_[] = {
+		{ 640,  480},
+		{1280,  720},
+		{1920, 1080}
+};
+const int NMB_FRAMES_ = sizeof(FRAMES_) / sizeof(FRAMES_[0]);
+
+// frames of the check: odd sizes around the steps of the vector loops
+// (16, 32, 48, 64 and 192 bytes), so that every tail is run
+const Frame CHECK_FRAMES_[] = {
+		{  1,   1}, {  3,   5}, { 15,   3}, { 17,   7}, { 31,   9}, { 33,  11},
+		{ 47,   5}, { 49,  13}, { 63,   3}, { 65,  17}, { 95,   7}, {127,  15},
+		{129,   9}, {191,  21}, {193,   5}, {255,  11}, {257,  31}, {641, 481}
+};
+const int NMB_CHECK_FRAMES_ = sizeof(CHECK_FRAMES_) / sizeof(CHECK_FRAMES_[0]);
+
+
+// command line
+char  *BASELINE_FILE_  = NULL;
+char  *WRITE_FILE_     = NULL;
+char  *KERNEL_FILTER_  = NULL;
+double TOLERANCE_      = 25.0;   // percent
+double MIN_TIME_       = 0.2;    // seconds per measurement
+int    RECHECKS_       = 3;      // measurements of a suspected regression
+bool   REPORT_ONLY_    = false;  // regressions don't fail
+bool   CHECK_          = false;  // compare the results instead of measuring
+
+
+void printInfo(int argc, char *argv[]);
+double now();
+void allocBuffers(const Frame &f, Buffers &b);
+void freeBuffers(Buffers &b);
+double measure(const Kernel &k, const Frame &f, Buffers &b, double *bytes);
+double measureVariant(const Kernel &k, const Frame &f, Buffers &b, int defaultVariant, double *gbPerSec);
+bool readBaseline(const char *fileName, map<string, double> &baseline);
+int checkKernels();
+
+
+/**
+ *
+ * @param argc number of command line parameter
+ * @param *argv[] list of parameters
+ */
+int main(int argc, char *argv[]){
+	printInfo(argc, argv);
+
+	if(CHECK_){
+		return (checkKernels() > 0) ? 1 : 0;
+	};
+
+	map<string, double> baseline;
+	if(BASELINE_FILE_ != NULL){
+		if(!readBaseline(BASELINE_FILE_, baseline)){
+			cerr << "Can't read baseline " << BASELINE_FILE_ << ", terminate process.\n";
+			exit(1);
+		};
+	};
+
+	FILE *out = NULL;
+	if(WRITE_FILE_ != NULL){
+		if((out = fopen(WRITE_FILE_, "w")) == NULL){
+			cerr << "Can't write baseline " << WRITE_FILE_ << ", terminate process.\n";
+			exit(1);
+		};
+		fprintf(out, "# baseline of benchImgKernels: <kernel> <width>x<height> <ns/pixel>\n");
+	};
+
+	int defaultVariant = ImgKernels::currentVariant();
+	printf("kernel variant: %s\n\n", ImgKernels::variantName(defaultVariant));
+	printf("%-18s %-10s %10s %10s %10s  %s\n", "kernel", "frame", "ns/pixel", "GB/s", "baseline", "");
+
+	vector<Suspect> suspects;
+	for(int i = 0; i < NMB_FRAMES_; i++){
+		Buffers b;
+		allocBuffers(FRAMES_[i], b);
+
+		for(int k = 0; k < NMB_KERNELS_; k++){
+			if((KERNEL_FILTER_ != NULL) && (strcmp(KERNEL_FILTER_, KERNELS_[k].name) != 0)) continue;
+			if(KERNELS_[k].variant > ImgKernels::bestVariant()) continue;
+
+			char frame[32];
+			sprintf(frame, "%dx%d", FRAMES_[i].width, FRAMES_[i].height);
+			string key = string(KERNELS_[k].name) + " " + string(frame);
+			map<string, double>::iterator it = baseline.find(key);
+			double limit = (it != baseline.end()) ? it->second * (1.0 + TOLERANCE_/100.0) : 1e30;
+
+			double gbPerSec;
+			double nsPerPixel = measureVariant(KERNELS_[k], FRAMES_[i], b, defaultVariant, &gbPerSec);
+
+			char ref[32] = "-";
+			const char *flag = "";
+			if(it != baseline.end()){
+				sprintf(ref, "%.3f", it->second);
+				if(nsPerPixel > limit){
+					flag = "slower, measured again";
+					Suspect suspect = {k, i, limit};
+					suspects.push_back(suspect);
+				};
+			};
+			printf("%-18s %-10s %10.3f %10.3f %10s  %s\n", KERNELS_[k].name, frame, nsPerPixel, gbPerSec, ref, flag);
+			fflush(stdout);
+
+			if(out != NULL){
+				fprintf(out, "%s %.3f\n", key.c_str(), nsPerPixel);
+			};
+		};
+
+		freeBuffers(b);
+	};
+
+	if(out != NULL){
+		fclose(out);
+	};
+
+	int nmbRegressions = 0;
+	if(!suspects.empty()){
+		printf("\nmeasured again on fresh buffers, the fastest of %d:\n", RECHECKS_);
+	};
+	for(size_t n = 0; n < suspects.size(); n++){
+		const Kernel &k = KERNELS_[suspects[n].kernel];
+		const Frame  &f = FRAMES_[suspects[n].frame];
+		double nsPerPixel = 1e30;
+		double gbPerSec   = 0.0;
+		for(int r = 0; (r < RECHECKS_) && (nsPerPixel > suspects[n].limit); r++){
+			Buffers b;
+			allocBuffers(f, b);
+			double gb;
+			double ns = measureVariant(k, f, b, defaultVariant, &gb);
+			freeBuffers(b);
+			if(ns < nsPerPixel){
+				nsPerPixel = ns;
+				gbPerSec   = gb;
+			};
+		};
+
+		char frame[32];
+		sprintf(frame, "%dx%d", f.width, f.height);
+		const char *flag = "";
+		if(nsPerPixel > suspects[n].limit){
+			flag = "REGRESSION";
+			nmbRegressions++;
+		};
+		printf("%-18s %-10s %10.3f %10.3f %10.3f  %s\n", k.name, frame, nsPerPixel, gbPerSec,
+				suspects[n].limit / (1.0 + TOLERANCE_/100.0), flag);
+	};
+
+	if(nmbRegressions > 0){
+		printf("\n%d regression(s) against %s (tolerance %.1f%%)\n", nmbRegressions, BASELINE_FILE_, TOLERANCE_);
+		return REPORT_ONLY_ ? 0 : 1;
+	};
+	return 0;
+};
+
+
+double now(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ((double) t.tv_sec) + ((double) t.tv_nsec) * 1e-9;
+};
+
+
+void allocBuffers(const Frame &f, Buffers &b){
+	int nmbPixel = f.width * f.height;
+
+	// rows of the OpenCV images are 4 byte aligned, like cvCreateImage does
+	b.bgrStep   = (3*f.width + 3) & ~3;
+	b.planeStep = (f.width + 3) & ~3;
+
+	b.rgb    = new unsigned char[3*nmbPixel];
+	b.bgr    = new unsigned char[b.bgrStep * f.height];
+	b.grey   = new unsigned char[nmbPixel];
+	b.planes = new unsigned char[4 * b.planeStep * f.height];
+	b.sum    = new unsigned char[nmbPixel];
+
+	ImgKernels::randomFill((char *) b.rgb, 3*nmbPixel);
+	ImgKernels::randomFill((char *) b.bgr, b.bgrStep * f.height);
+
+	// dark frame with a bright square in the middle
+	memset(b.grey, 0, nmbPixel);
+	int x0 = max(f.width/2 - 16, 0);
+	int x1 = min(f.width/2 + 16, f.width);
+	for(int i = max(f.height/2 - 16, 0); i < min(f.height/2 + 16, f.height); i++){
+		memset(b.grey + i*f.width + x0, 255, x1 - x0);
+	};
+	ImgKernels::clearBlobScan(&b.scan);
+};
+
+
+void freeBuffers(Buffers &b){
+	delete [] b.rgb;
+	delete [] b.bgr;
+	delete [] b.grey;
+	delete [] b.planes;
+	delete [] b.sum;
+};
+
+
+/**
+ *
+ * \brief Runs the kernel repeatedly for at least MIN_TIME_ seconds and
+ * returns the fastest single run in seconds.
+ *
+ */
+double measure(const Kernel &k, const Frame &f, Buffers &b, double *bytes){
+	// warm up caches and page tables
+	*bytes = k.run(f, b);
+
+	double best  = 1e30;
+	double start = now();
+	int    runs  = 0;
+	do{
+		double t0 = now();
+		k.run(f, b);
+		double t1 = now();
+		if((t1 - t0) < best) best = t1 - t0;
+		runs++;
+	}while(((now() - start) < MIN_TIME_) || (runs < 5));
+
+	return best;
+};
+
+
+/**
+ *
+ * \brief measure() with the variant of the kernel, in ns/pixel.
+ *
+ */
+double measureVariant(const Kernel &k, const Frame &f, Buffers &b, int defaultVariant, double *gbPerSec){
+	double bytes;
+	ImgKernels::useVariant((k.variant < 0) ? defaultVariant : k.variant);
+	double seconds = measure(k, f, b, &bytes);
+	ImgKernels::useVariant(defaultVariant);
+	*gbPerSec = bytes / seconds / 1e9;
+	return 1e9 * seconds / (f.width * f.height);
+};
+
+
+bool readBaseline(const char *fileName, map<string, double> &baseline){
+	FILE *in = fopen(fileName, "r");
+	if(in == NULL){
+		return false;
+	};
+
+	char line[256];
+	char name[64], frame[32];
+	double nsPerPixel;
+	while(fgets(line, sizeof(line), in) != NULL){
+		if(line[0] == '#') continue;
+		if(sscanf(line, "%63s %31s %lf", name, frame, &nsPerPixel) == 3){
+			baseline[string(name) + " " + string(frame)] = nsPerPixel;
+		};
+	};
+	fclose(in);
+	return true;
+};
+
+
+/**
+ *
+ * \brief Buffers of a check frame: the same random bytes for every run
+ * of the frame, a grey frame of noise up to 128 and a few brighter
+ * pixels, destinations cleared.
+ *
+ */
+void allocCheckBuffers(const Frame &f, Buffers &b){
+	srand(7919 * f.width + f.height);
+	allocBuffers(f, b);
+
+	int nmbPixel = f.width * f.height;
+	for(int n = 0; n < nmbPixel; n++){
+		int v = ImgKernels::randomByte();
+		b.grey[n] = (v < 4) ? 129 + ImgKernels::randomByte() % 127 : v % 129;
+	};
+	b.grey[nmbPixel - 1] = 255;
+	memset(b.planes, 0, 4 * b.planeStep * f.height);
+	memset(b.sum, 0, nmbPixel);
+};
+
+
+bool sameScan(const ImgKernels::BlobScanResult &a, const ImgKernels::BlobScanResult &b){
+	return (a.firstRow == b.firstRow) && (a.firstRowX == b.firstRowX) &&
+	       (a.lastRow  == b.lastRow)  && (a.lastRowX  == b.lastRowX)  &&
+	       (a.firstCol == b.firstCol) && (a.firstColY == b.firstColY) &&
+	       (a.lastCol  == b.lastCol)  && (a.lastColY  == b.lastColY)  &&
+	       (a.count == b.count) && (a.sumX == b.sumX) && (a.sumY == b.sumY);
+};
+
+
+/**
+ *
+ * \brief Compares the destinations of two runs, what names the first
+ * buffer differing.
+ *
+ */
+bool sameOutputs(const Frame &f, const Buffers &a, const Buffers &b, string *what){
+	int nmbPixel = f.width * f.height;
+	if(memcmp(a.rgb, b.rgb, 3*nmbPixel) != 0){
+		*what = "rgb";
+	}else if(memcmp(a.bgr, b.bgr, a.bgrStep * f.height) != 0){
+		*what = "bgr";
+	}else if(memcmp(a.planes, b.planes, 4 * a.planeStep * f.height) != 0){
+		*what = "planes";
+	}else if(memcmp(a.sum, b.sum, nmbPixel) != 0){
+		*what = "sum";
+	}else if(!sameScan(a.scan, b.scan)){
+		*what = "scan";
+	}else{
+		return true;
+	};
+	return false;
+};
+
+
+/**
+ *
+ * \brief ImgKernels::blobScanWindow() pixel by pixel in row order.
+ *
+ */
+void naiveBlobScanWindow(const unsigned char *grey, int width, int x0, int y0, int x1, int y1, int thresh,
+		ImgKernels::BlobScanResult *result){
+	ImgKernels::clearBlobScan(result);
+	for(int i = y0; i < y1; i++){
+		for(int j = x0; j < x1; j++){
+			if(grey[i*width + j] <= thresh) continue;
+			if(result->firstRow < 0){
+				result->firstRow  = i;
+				result->firstRowX = j;
+			};
+			result->lastRow  = i;
+			result->lastRowX = j;
+			if((result->firstCol < 0) || (j < result->firstCol)){
+				result->firstCol  = j;
+				result->firstColY = i;
+			};
+			if(j >= result->lastCol){
+				result->lastCol  = j;
+				result->lastColY = i;
+			};
+			result->count++;
+			result->sumX += j;
+			result->sumY += i;
+		};
+	};
+};
+
+
+bool blobBefore(const Blob &a, const Blob &b){
+	if(a.minY != b.minY) return a.minY < b.minY;
+	if(a.minX != b.minX) return a.minX < b.minX;
+	if(a.maxY != b.maxY) return a.maxY < b.maxY;
+	if(a.maxX != b.maxX) return a.maxX < b.maxX;
+	return a.area < b.area;
+};
+
+
+/**
+ *
+ * \brief BlobLabeler::label() by a flood fill of every pixel above the
+ * threshold (8-neighbourhood), the blobs in no particular order.
+ *
+ */
+void naiveLabel(const unsigned char *grey, int width, int height, int thresh, int minArea, vector<Blob> *blobs){
+	vector<char> seen(width * height, 0);
+	vector<int>  stack;
+	blobs->clear();
+	for(int n = 0; n < width * height; n++){
+		if(seen[n] || (grey[n] <= thresh)) continue;
+
+		Blob b = {width, height, -1, -1, 0, 0.0, 0.0};
+		long long sumX = 0, sumY = 0;
+		seen[n] = 1;
+		stack.push_back(n);
+		while(!stack.empty()){
+			int p = stack.back();
+			stack.pop_back();
+			int x = p % width, y = p / width;
+			b.minX = min(b.minX, x); b.maxX = max(b.maxX, x);
+			b.minY = min(b.minY, y); b.maxY = max(b.maxY, y);
+			b.area++;
+			sumX += x;
+			sumY += y;
+			for(int dy = -1; dy <= 1; dy++){
+				for(int dx = -1; dx <= 1; dx++){
+					int nx = x + dx, ny = y + dy;
+					if((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height)) continue;
+					int q = ny*width + nx;
+					if(!seen[q] && (grey[q] > thresh)){
+						seen[q] = 1;
+						stack.push_back(q);
+					};
+				};
+			};
+		};
+		if(b.area >= minArea){
+			b.centroidX = ((double) sumX) / b.area;
+			b.centroidY = ((double) sumY) / b.area;
+			blobs->push_back(b);
+		};
+	};
+};
+
+
+bool sameBlobs(vector<Blob> a, vector<Blob> b){
+	if(a.size() != b.size()){
+		return false;
+	};
+	sort(a.begin(), a.end(), blobBefore);
+	sort(b.begin(), b.end(), blobBefore);
+	for(size_t n = 0; n < a.size(); n++){
+		if((a[n].minX != b[n].minX) || (a[n].minY != b[n].minY) ||
+		   (a[n].maxX != b[n].maxX) || (a[n].maxY != b[n].maxY) || (a[n].area != b[n].area) ||
+		   (fabs(a[n].centroidX - b[n].centroidX) > 1e-9) || (fabs(a[n].centroidY - b[n].centroidY) > 1e-9)){
+			return false;
+		};
+	};
+	return true;
+};
+
+
+/**
+ *
+ * \brief The blob scans of whole frames, of windows and of pyramids and
+ * the blob labeler with the current variant against the naive loops.
+ *
+ * \return false on a mismatch, what describes it
+ */
+bool checkScans(const Frame &f, const Buffers &b, WorkerPool *pool, string *what){
+	const int THRESHS[] = {-1, 0, 90, 128, 254, 255};
+	char text[128];
+	ImgKernels::BlobScanResult result, expected;
+
+	for(int t = 0; t < (int) (sizeof(THRESHS) / sizeof(THRESHS[0])); t++){
+		// the whole frame and random windows, empty ones included
+		for(int w = 0; w < 9; w++){
+			int x0 = 0, y0 = 0, x1 = f.width, y1 = f.height;
+			if(w > 0){
+				x0 = rand() % f.width;  x1 = x0 + rand() % (f.width - x0 + 1);
+				y0 = rand() % f.height; y1 = y0 + rand() % (f.height - y0 + 1);
+			};
+			ImgKernels::blobScanWindow(b.grey, f.width, x0, y0, x1, y1, THRESHS[t], &result);
+			naiveBlobScanWindow(b.grey, f.width, x0, y0, x1, y1, THRESHS[t], &expected);
+			if(!sameScan(result, expected)){
+				sprintf(text, "blobScanWindow %d,%d-%d,%d thresh %d", x0, y0, x1, y1, THRESHS[t]);
+				*what = text;
+				return false;
+			};
+		};
+
+		naiveBlobScanWindow(b.grey, f.width, 0, 0, f.width, f.height, THRESHS[t], &expected);
+		for(int levels = 1; levels <= 4; levels++){
+			MaxPyramid pyramid(levels);
+			pyramid.build(b.grey, f.width, f.height);
+			pyramid.blobScan(THRESHS[t], &result);
+			if(!sameScan(result, expected)){
+				sprintf(text, "MaxPyramid::blobScan %d levels thresh %d", levels, THRESHS[t]);
+				*what = text;
+				return false;
+			};
+		};
+	};
+
+	// noise up to 128 above 90 is about 30% of the pixels, large
+	// connected blobs of any shape
+	const int LABEL_THRESHS[] = {90, 128};
+	for(int t = 0; t < 2; t++){
+		for(int minArea = 1; minArea <= 3; minArea += 2){
+			vector<Blob> expectedBlobs;
+			naiveLabel(b.grey, f.width, f.height, LABEL_THRESHS[t], minArea, &expectedBlobs);
+
+			BlobLabeler single, banded(pool);
+			MaxPyramid  pyramid(4);
+			pyramid.build(b.grey, f.width, f.height);
+			single.label(b.grey, f.width, f.height, LABEL_THRESHS[t], minArea);
+			banded.label(b.grey, f.width, f.height, LABEL_THRESHS[t], minArea, &pyramid);
+			const char *labeler = NULL;
+			if(!sameBlobs(single.blobs(), expectedBlobs)){
+				labeler = "BlobLabeler";
+			}else if(!sameBlobs(banded.blobs(), expectedBlobs)){
+				labeler = "BlobLabeler with bands and pyramid";
+			};
+			if(labeler != NULL){
+				sprintf(text, "%s thresh %d minArea %d", labeler, LABEL_THRESHS[t], minArea);
+				*what = text;
+				return false;
+			};
+		};
+	};
+	return true;
+};
+
+
+/**
+ *
+ * \brief The color filter as it was computed before the fixed point
+ * kernels, in float: the filter outputs are exact, the sum differs by
+ * one at most.
+ *
+ */
+void floatColorFilter(const unsigned char *rgb, int width, int height, const ImgKernels::ColorFilterParams &p,
+		unsigned char *outR, unsigned char *outG, unsigned char *outB, unsigned char *sum){
+	for(int i = 0; i < width * height; i++){
+		unsigned int valueR = rgb[3*i];
+		unsigned int valueG = rgb[3*i + 1];
+		unsigned int valueB = rgb[3*i + 2];
+
+		int fR = ((valueR > (unsigned int) p.rFilterThreshR) && (valueG < (unsigned int) p.rFilterThreshG) &&
+		          (valueB < (unsigned int) p.rFilterThreshB)) ? valueR : 0;
+		int fG = ((valueG > (unsigned int) p.gFilterThreshG) && (valueR < (unsigned int) p.gFilterThreshR) &&
+		          (valueB < (unsigned int) p.gFilterThreshB)) ? valueG : 0;
+		int fB = ((valueB > (unsigned int) p.bFilterThreshB) && (valueG < (unsigned int) p.bFilterThreshG) &&
+		          (valueR < (unsigned int) p.bFilterThreshR)) ? valueB : 0;
+
+		unsigned int s = (unsigned int) ((((float) p.sumPartB)/100.0)*((float) fB) +
+		                                 (((float) p.sumPartG)/100.0)*((float) fG) +
+		                                 (((float) p.sumPartR)/100.0)*((float) fR) + p.sumAdd);
+		outR[i] = fR;
+		outG[i] = fG;
+		outB[i] = fB;
+		sum[i]  = (s > 255) ? 255 : s;
+	};
+};
+
+
+/**
+ *
+ * \brief The color filter with the given variant, random parameters
+ * and the extreme ones, against the scalar variant (same bytes) and
+ * the float formula; colorFilterLut() against colorFilter() (same
+ * bytes), colorBlobScan() and colorBlobScanWindow() against the blob
+ * scans of the sum.
+ *
+ * \return false on a mismatch, what describes it
+ */
+bool checkColorFilter(const Frame &f, const Buffers &b, int variant, string *what){
+	int nmbPixel  = f.width * f.height;
+	int planeSize = b.planeStep * f.height;
+	vector<unsigned char> planes(4 * planeSize), expectedPlanes(4 * planeSize);
+	vector<unsigned char> sum(nmbPixel), expectedSum(nmbPixel);
+	vector<unsigned char> lutPlanes(4 * planeSize), lutSum(nmbPixel);
+	vector<unsigned char> floatPlanes(3 * nmbPixel), floatSum(nmbPixel);
+	char text[128];
+
+	for(int n = 0; n < 24; n++){
+		ImgKernels::ColorFilterParams p = {162, 143, 255, 126, 140, 209, 87, 255, 149, 30, 30, 40, 0};
+		if(n == 1){
+			ImgKernels::ColorFilterParams extreme = {0, 255, 255, 255, 0, 255, 255, 255, 0, 100, 100, 100, 255};
+			p = extreme;
+		}else if(n == 2){
+			ImgKernels::ColorFilterParams extreme = {255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 0};
+			p = extreme;
+		}else if(n > 2){
+			int *values = &p.rFilterThreshR;
+			for(int k = 0; k < 9; k++) values[k] = rand() % 256;
+			p.sumPartR = rand() % 101; p.sumPartG = rand() % 101; p.sumPartB = rand() % 101;
+			p.sumAdd   = (n & 1) ? 0 : rand() % 256;
+		};
+
+		ImgKernels::useVariant(ImgKernels::VARIANT_SCALAR);
+		ImgKernels::colorFilter(b.rgb, f.width, f.height, p, &expectedPlanes[0], &expectedPlanes[planeSize],
+				&expectedPlanes[2*planeSize], &expectedPlanes[3*planeSize], b.planeStep, &expectedSum[0]);
+		ImgKernels::useVariant(variant);
+		ImgKernels::colorFilter(b.rgb, f.width, f.height, p, &planes[0], &planes[planeSize],
+				&planes[2*planeSize], &planes[3*planeSize], b.planeStep, &sum[0]);
+		floatColorFilter(b.rgb, f.width, f.height, p,
+				&floatPlanes[0], &floatPlanes[nmbPixel], &floatPlanes[2*nmbPixel], &floatSum[0]);
+
+		// the lookup tables of the prepared parameters classify as the thresholds
+		ImgKernels::ColorFilterPrepared prepared;
+		ImgKernels::prepareColorFilter(p, &prepared);
+		ImgKernels::colorFilterLut(b.rgb, f.width, f.height, prepared, &lutPlanes[0], &lutPlanes[planeSize],
+				&lutPlanes[2*planeSize], &lutPlanes[3*planeSize], b.planeStep, &lutSum[0]);
+
+		const char *mismatch = NULL;
+		if((planes != expectedPlanes) || (sum != expectedSum)){
+			mismatch = "colorFilter differs from the scalar variant";
+		}else if((lutPlanes != planes) || (lutSum != sum)){
+			mismatch = "colorFilterLut differs from colorFilter";
+		};
+
+		// the fused scan of the whole frame and of a random window
+		// against the scan of the sum
+		int x0 = rand() % f.width,  x1 = x0 + rand() % (f.width - x0 + 1);
+		int y0 = rand() % f.height, y1 = y0 + rand() % (f.height - y0 + 1);
+		int thresh = (n < 3) ? 128 : rand() % 256 - 1;
+		ImgKernels::BlobScanResult result, expected;
+		ImgKernels::blobScan(&sum[0], f.width, f.height, thresh, &expected);
+		ImgKernels::colorBlobScan(b.rgb, f.width, f.height, prepared, thresh, &result);
+		if((mismatch == NULL) && !sameScan(result, expected)){
+			mismatch = "colorBlobScan differs from blobScan of the sum";
+		};
+		ImgKernels::blobScanWindow(&sum[0], f.width, x0, y0, x1, y1, thresh, &expected);
+		ImgKernels::colorBlobScanWindow(b.rgb, f.width, x0, y0, x1, y1, prepared, thresh, &result);
+		if((mismatch == NULL) && !sameScan(result, expected)){
+			mismatch = "colorBlobScanWindow differs from blobScanWindow of the sum";
+		};
+		for(int i = 0; (mismatch == NULL) && (i < f.height); i++){
+			for(int j = 0; j < f.width; j++){
+				int m = i*f.width + j;
+				if((planes[i*b.planeStep + j] != floatPlanes[m]) ||
+				   (planes[planeSize + i*b.planeStep + j] != floatPlanes[nmbPixel + m]) ||
+				   (planes[2*planeSize + i*b.planeStep + j] != floatPlanes[2*nmbPixel + m])){
+					mismatch = "colorFilter output differs from the float formula";
+				}else if(abs(sum[m] - floatSum[m]) > 1){
+					mismatch = "colorFilter sum differs from the float formula by more than 1";
+				}else if(planes[3*planeSize + i*b.planeStep + j] != sum[m]){
+					mismatch = "colorFilter sum image differs from the sum";
+				};
+				if(mismatch != NULL) break;
+			};
+		};
+		if(mismatch != NULL){
+			sprintf(text, "%s, parameters %d", mismatch, n);
+			*what = text;
+			return false;
+		};
+	};
+	return true;
+};
+
+
+/**
+ *
+ * \brief Runs the checks of -check.
+ *
+ * \return number of mismatches
+ */
+int checkKernels(){
+	int defaultVariant = ImgKernels::currentVariant();
+	int nmbMismatches  = 0;
+
+	printf("every variant against the scalar one:\n");
+	for(int k = 0; k < NMB_KERNELS_; k++){
+		if(KERNELS_[k].variant != ImgKernels::VARIANT_SCALAR) continue;
+
+		for(int v = k + 1; (v < NMB_KERNELS_) && (KERNELS_[v].run == KERNELS_[k].run); v++){
+			if(KERNELS_[v].variant > ImgKernels::bestVariant()) continue;
+
+			string what;
+			int    i = 0;
+			for(; i < NMB_CHECK_FRAMES_; i++){
+				const Frame &f = CHECK_FRAMES_[i];
+				Buffers expected, b;
+				allocCheckBuffers(f, expected);
+				allocCheckBuffers(f, b);
+				ImgKernels::useVariant(ImgKernels::VARIANT_SCALAR);
+				KERNELS_[k].run(f, expected);
+				ImgKernels::useVariant(KERNELS_[v].variant);
+				KERNELS_[v].run(f, b);
+				bool same = sameOutputs(f, expected, b, &what);
+				freeBuffers(expected);
+				freeBuffers(b);
+				if(!same) break;
+			};
+			ImgKernels::useVariant(defaultVariant);
+
+			if(i < NMB_CHECK_FRAMES_){
+				printf("%-26s MISMATCH %dx%d: %s\n", KERNELS_[v].name,
+						CHECK_FRAMES_[i].width, CHECK_FRAMES_[i].height, what.c_str());
+				nmbMismatches++;
+			}else{
+				printf("%-26s ok\n", KERNELS_[v].name);
+			};
+		};
+	};
+
+	printf("\nblob scans and labeler against naive loops:\n");
+	WorkerPool pool(3);
+	for(int v = ImgKernels::VARIANT_SCALAR; v <= ImgKernels::bestVariant(); v++){
+		ImgKernels::useVariant(v);
+		string what;
+		int    i = 0;
+		for(; i < NMB_CHECK_FRAMES_; i++){
+			Buffers b;
+			allocCheckBuffers(CHECK_FRAMES_[i], b);
+			bool same = checkScans(CHECK_FRAMES_[i], b, &pool, &what);
+			freeBuffers(b);
+			if(!same) break;
+		};
+
+		if(i < NMB_CHECK_FRAMES_){
+			printf("%-26s MISMATCH %dx%d: %s\n", ImgKernels::variantName(v),
+					CHECK_FRAMES_[i].width, CHECK_FRAMES_[i].height, what.c_str());
+			nmbMismatches++;
+		}else{
+			printf("%-26s ok\n", ImgKernels::variantName(v));
+		};
+	};
+
+	printf("\ncolor filters against the scalar variant and the float formula:\n");
+	for(int v = ImgKernels::VARIANT_SCALAR; v <= ImgKernels::bestVariant(); v++){
+		string what;
+		int    i = 0;
+		for(; i < NMB_CHECK_FRAMES_; i++){
+			Buffers b;
+			allocCheckBuffers(CHECK_FRAMES_[i], b);
+			bool same = checkColorFilter(CHECK_FRAMES_[i], b, v, &what);
+			freeBuffers(b);
+			if(!same) break;
+		};
+
+		if(i < NMB_CHECK_FRAMES_){
+			printf("%-26s MISMATCH %dx%d: %s\n", ImgKernels::variantName(v),
+					CHECK_FRAMES_[i].width, CHECK_FRAMES_[i].height, what.c_str());
+			nmbMismatches++;
+		}else{
+			printf("%-26s ok\n", ImgKernels::variantName(v));
+		};
+	};
+	ImgKernels::useVariant(defaultVariant);
+
+	if(nmbMismatches > 0){
+		printf("\n%d mismatch(es)\n", nmbMismatches);
+	};
+	return nmbMismatches;
+};
+
+
+void printInfo(int argc, char *argv[]){
+	for(int i = 1; i < argc; i++){
+		if((!strcmp(argv[i], "-baseline")) && (i+1 < argc)){
+			BASELINE_FILE_ = argv[++i];
+		}else if((!strcmp(argv[i], "-write")) && (i+1 < argc)){
+			WRITE_FILE_ = argv[++i];
+		}else if((!strcmp(argv[i], "-tolerance")) && (i+1 < argc)){
+			TOLERANCE_ = atof(argv[++i]);
+		}else if(!strcmp(argv[i], "-report")){
+			REPORT_ONLY_ = true;
+		}else if(!strcmp(argv[i], "-check")){
+			CHECK_ = true;
+		}else if((!strcmp(argv[i], "-kernel")) && (i+1 < argc)){
+			KERNEL_FILTER_ = argv[++i];
+		}else if((!strcmp(argv[i], "-time")) && (i+1 < argc)){
+			MIN_TIME_ = atof(argv[++i]);
+		}else{
+			cerr << "Usage of " << argv[0] << " : \n\n"
+			     << argv[0] << " [-baseline <file>] [-write <file>] [-tolerance <percent>] [-report] [-kernel <name>] [-time <sec>]\n"
+			     << argv[0] << " -check" << endl;
+			cerr << "\n"
+			     << "-baseline <file>     compare with the stored baseline, flag regressions\n"
+			     << "-write <file>        store the results as new baseline\n"
+			     << "-tolerance <percent> allowed slow down against the baseline (default 25),\n"
+			     << "                     a slower kernel is measured again up to 3 times\n"
+			     << "-report              flag regressions, but don't return 1 for them\n"
+			     << "-kernel <name>       run this kernel only\n"
+			     << "-time <sec>          minimal measuring time per kernel and frame (default 0.2)\n"
+			     << "-check               compare the results of all variants with the scalar\n"
+			     << "                     ones and with naive loops instead of measuring\n";
+			exit(1);
+		};
+	};
+};
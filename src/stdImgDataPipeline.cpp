@@ -0,0 +1,345 @@
+/*
+    This program runs the color filter and the blob detector in one
+    process and provides the outputs of all stages as standard image
+    data servers.
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ *
+ * \file stdImgDataPipeline.cpp
+ *
+ * \brief Chains the stages of stdImgDataServerClientColorFilter and
+ * stdImgDataServerClientBlobDetector in one process: the RGB image data
+ * of a standard image data server (or of a synthetic scene rendered in
+ * the process) are filtered and the blob detector works on the filter
+ * output in place, no frame is sent or copied between the stages.
+ *
+ * Every stage is still served by the standard protocol, on three
+ * consecutive ports:
+ *
+ *     <first port>     the RGB image data received (or rendered)
+ *     <first port>+1   the sum of the color filter
+ *     <first port>+2   the blob detector (blob coordinates, GET_BLOBS)
+ *
+ * The parameters of the stages are set by SET_PARAM on their ports.
+ *
+ * With -fused the color filter and the blob detector are replaced by a
+ * ColorBlobStage served on <first port>+2, which finds the blob in the
+ * RGB image data in one pass (no GET_BLOBS, no filter output).
+ *
+ */
+
+#include <iostream>           // For cerr and cout
+#include <cstdlib>            // For atoi()
+#include <cstring>            // For strcmp()
+#include <cstdio>
+#include <time.h>
+
+// communication
+#include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
+#include "../include/StdImgDataServerProtocol.H"
+#include "../include/StdImgClient.H"
+
+// stages
+#include "../include/Stage.H"
+#include "../include/StageServer.H"
+#include "../include/ColorFilterStage.H"
+#include "../include/BlobDetectorStage.H"
+#include "../include/ColorBlobStage.H"
+
+// in-process source
+#include "../include/SyntheticScene.H"
+#include "../include/FramePacer.H"
+
+
+// On Linux, you must compile with the -D_REENTRANT option.  This tells
+// the C/C++ libraries that the functions must be thread-safe
+#ifndef _REENTRANT
+#error ACK! You need to compile with _REENTRANT defined since this uses threads
+#endif
+
+
+#define NMB_STAGES 3
+
+unsigned short FIRST_PORT_;
+unsigned short SOURCE_SERVER_PORT_;
+char          *SOURCE_SERVER_ADR_ = NULL;   // NULL: synthetic scene
+
+StdImgClient *dataSource_ = NULL;
+int imageWidth_;
+int imageHeight_;
+int colorValue_;
+
+// synthetic scene (-sim), see stdImgDataServerSim
+SyntheticScene *scene_ = NULL;
+int    NMB_DISCS_   = 3;
+int    DISC_RADIUS_ = 20;
+double SPEED_       = 2.0;
+int    NOISE_       = 0;
+double FPS_         = 0.0;    // 0: as fast as possible
+
+// stages
+int FILTER_THREADS_ = 0;    // 0: one per CPU
+int FILTER_LUT_     = 0;    // 1: classify by lookup tables
+int LABEL_THREADS_  = 1;
+int PYRAMID_LEVELS_ = 0;
+int TRACK_MARGIN_   = 0;
+int TRACK_BUDGET_   = 0;
+int FUSED_          = 0;    // 1: ColorBlobStage instead of filter and detector
+
+InputStage        *input_    = NULL;
+ColorFilterStage  *filter_   = NULL;
+BlobDetectorStage *detector_ = NULL;
+ColorBlobStage    *fused_    = NULL;
+
+// frame rate report every REPORT_PERIOD_ seconds
+const double REPORT_PERIOD_ = 10.0;
+
+
+void printInfo(int argc, char *argv[]);
+void readOptions(int argc, char *argv[], int first);
+double now();
+
+
+/**
+ *
+ * @param argc number of command line parameter
+ * @param *argv[] list of parameters
+ */
+int main(int argc, char *argv[]){
+	printInfo(argc,argv);
+
+	// servers of the stages, bound before anything else is done; the
+	// fused stage has no filter output
+	StageServer *servers[NMB_STAGES];
+	for(int k = 0; k < NMB_STAGES; k++){
+		servers[k] = NULL;
+		if(FUSED_ && (k == 1)){
+			continue;
+		};
+		try {
+			servers[k] = new StageServer(FIRST_PORT_ + k);
+		}catch (SocketException &e) {
+			cerr << e.what() << endl;
+			exit(1);
+		};
+	};
+
+	// source of the rgb data
+	int reserve = 0;
+	if(SOURCE_SERVER_ADR_ != NULL){
+		try{
+			dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
+		}catch(string msg){
+			cout << msg << endl << endl;
+			exit(1);
+		};
+		const StdImgMetaData &meta = dataSource_->metaData();
+		imageWidth_  = meta.width;
+		imageHeight_ = meta.height;
+		colorValue_  = meta.color;
+		printf("Receive image data %i x %i  total bytes %i \n", imageWidth_, imageHeight_, dataSource_->frameSize());
+		if(colorValue_ < 1){
+			cout << "Image data must be color data.\n";
+			exit(1);
+		};
+		// the time stamp, if any, is received behind the image data
+		reserve = dataSource_->frameSize() - 3*imageWidth_*imageHeight_;
+	}else{
+		colorValue_ = 1;
+		scene_ = new SyntheticScene(imageWidth_, imageHeight_, colorValue_,
+				NMB_DISCS_, DISC_RADIUS_, SPEED_, NOISE_, (unsigned long long) time(NULL));
+		cout << "Scene " << imageWidth_ << " x " << imageHeight_ << ": " << NMB_DISCS_ << " discs, radius "
+		     << DISC_RADIUS_ << ", speed " << SPEED_ << ", noise " << NOISE_ << endl;
+	};
+
+	input_    = new InputStage(imageWidth_, imageHeight_, colorValue_, reserve);
+	Stage *stages[NMB_STAGES] = {input_, NULL, NULL};
+	if(FUSED_){
+		fused_ = new ColorBlobStage(imageWidth_, imageHeight_, FILTER_THREADS_);
+		stages[2] = fused_;
+		printf("Fused color filter and blob detector on %i thread(s)\n", fused_->nmbThreads());
+	}else{
+		filter_   = new ColorFilterStage(imageWidth_, imageHeight_, FILTER_THREADS_, FILTER_LUT_ != 0);
+		detector_ = new BlobDetectorStage(imageWidth_, imageHeight_, LABEL_THREADS_, PYRAMID_LEVELS_);
+		detector_->track(TRACK_MARGIN_, TRACK_BUDGET_);
+		stages[1] = filter_;
+		stages[2] = detector_;
+		printf("Color filter on %i thread(s)\n", filter_->nmbThreads());
+	};
+
+	// the servers run until the process ends, the stages are never deleted
+	for(int k = 0; k < NMB_STAGES; k++){
+		if(servers[k] != NULL){
+			servers[k]->start(stages[k]);
+		};
+	};
+	if(FUSED_){
+		printf("Stages served on ports %i (image data), %i (blob detector)\n",
+				FIRST_PORT_, FIRST_PORT_ + 2);
+	}else{
+		printf("Stages served on ports %i (image data), %i (color filter), %i (blob detector)\n",
+				FIRST_PORT_, FIRST_PORT_ + 1, FIRST_PORT_ + 2);
+	};
+
+	FramePacer pacer(FPS_);
+	pacer.start();
+	long   frames     = 0;
+	double lastReport = now();
+	do{
+		// every stage works on the output of the previous one in place
+		input_->lock();
+		bool received = true;
+		if(scene_ != NULL){
+			scene_->render((char *) input_->buffer());
+			scene_->step();
+		}else{
+			received = dataSource_->receive(input_->buffer());
+		};
+		if(received){
+			input_->processed();
+		};
+		input_->unlock();
+		if(!received){
+			break;
+		};
+
+		if(fused_ != NULL){
+			fused_->lock();
+			fused_->process(input_->output());
+			fused_->processed();
+			fused_->unlock();
+		}else{
+			filter_->lock();
+			filter_->process(input_->output());
+			filter_->processed();
+			filter_->unlock();
+
+			detector_->lock();
+			detector_->process(filter_->output());
+			detector_->processed();
+			detector_->unlock();
+		};
+
+		frames++;
+		if(now() - lastReport >= REPORT_PERIOD_){
+			printf("%ld frames, %.1f frames/s\n", frames, frames / (now() - lastReport));
+			fflush(stdout);
+			frames     = 0;
+			lastReport = now();
+		};
+		if(pacer.enabled()){
+			pacer.wait();
+		};
+	}while(true);
+
+	cout << "Image data server closed the connection.\n";
+	delete dataSource_;
+	exit(0);
+};
+
+
+double now(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+
+void printInfo(int argc, char *argv[]){
+	if ((argc < 4) || ((argc < 5) && !strcmp(argv[2], "-sim"))){     // Test for correct number of arguments
+		cerr << "Usage: " << argv[0]
+		     << " <first port> <Server of Data> <Port of Server of Data> [options]\n"
+		     << "       " << argv[0]
+		     << " <first port> -sim <width> <height> [options]" << endl;
+		cerr << "\n"
+		     << "Serves the received (or rendered) image data on <first port>, the\n"
+		     << "color filter on <first port>+1 and the blob detector on <first port>+2.\n"
+		     << "\n"
+		     << "options:\n"
+		     << "-threads <n>      threads of the color filter (default: one per CPU)\n"
+		     << "-lut <0|1>        1: color filter by lookup tables\n"
+		     << "-labelThreads <n> threads labeling the blobs of GET_BLOBS (default 1)\n"
+		     << "-track <m>        track the blob with a margin of m pixels (default 0: off)\n"
+		     << "-trackBudget <r>  search a lost blob in bands of r rows per frame\n"
+		     << "-pyramid <l>      pyramid of 2^l x 2^l blocks, speeds up the labeling\n"
+		     << "                  of GET_BLOBS only (default 0: off)\n"
+		     << "-fused <0|1>      1: color filter and blob detection in one pass\n"
+		     << "                  (ColorBlobStage, no GET_BLOBS, -threads only)\n"
+		     << "\n"
+		     << "options of -sim (see stdImgDataServerSim):\n"
+		     << "-discs <n>        number of discs (default 3)\n"
+		     << "-radius <r>       disc radius in pixels (default 20)\n"
+		     << "-speed <s>        disc speed in pixels per frame (default 2)\n"
+		     << "-noise <a>        noise amplitude (default 0)\n"
+		     << "-fps <f>          frames per second (default: as fast as possible)\n";
+		exit(1);
+	};
+
+	FIRST_PORT_ = atoi(argv[1]);
+	if(!strcmp(argv[2], "-sim")){
+		imageWidth_  = atoi(argv[3]);
+		imageHeight_ = atoi(argv[4]);
+		if((imageWidth_ < 1) || (imageHeight_ < 1)){
+			cerr << "Invalid size of the scene, terminate process.\n";
+			exit(1);
+		};
+		readOptions(argc, argv, 5);
+	}else{
+		SOURCE_SERVER_ADR_  = argv[2];
+		SOURCE_SERVER_PORT_ = atoi(argv[3]);
+		readOptions(argc, argv, 4);
+	};
+};
+
+
+void readOptions(int argc, char *argv[], int first){
+	for(int i = first; i < argc; i++){
+		if(i+1 == argc){
+			cerr << "No value of option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		}else if(!strcmp(argv[i], "-threads")){
+			FILTER_THREADS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-lut")){
+			FILTER_LUT_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-labelThreads")){
+			LABEL_THREADS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-track")){
+			TRACK_MARGIN_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-trackBudget")){
+			TRACK_BUDGET_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-fused")){
+			FUSED_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-pyramid")){
+			PYRAMID_LEVELS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-discs")){
+			NMB_DISCS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-radius")){
+			DISC_RADIUS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-speed")){
+			SPEED_ = atof(argv[++i]);
+		}else if(!strcmp(argv[i], "-noise")){
+			NOISE_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-fps")){
+			FPS_ = atof(argv[++i]);
+		}else{
+			cerr << "Unknown option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		};
+	};
+};
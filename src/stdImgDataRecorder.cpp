@@ -0,0 +1,178 @@
+/*
+    This program is an implementation of a client connecting
+    to a standard image data server and recording the image
+    data provided by the server.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ *
+ * \file stdImgDataRecorder.cpp
+ *
+ * \brief Requests frames from any standard image data server and
+ * appends them with the time of reception to a recording, which can
+ * be served again by stdImgDataServerReplay.
+ *
+ */
+
+
+#include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
+#include <iostream>           // For cerr and cout
+#include <cstdlib>            // For atoi()
+#include <sys/time.h>
+
+#include "../include/StdImgDataServerProtocol.H"
+#include "../include/FrameRecording.H"
+#include "../include/StdImgClient.H"
+
+StdImgClient  *dataSource_ = NULL;
+unsigned short SOURCE_SERVER_PORT_;
+char          *SOURCE_SERVER_ADR_;
+char          *RECORDING_FILE_;
+int            MAX_FRAMES_ = 0;   // 0: record until the server terminates
+
+unsigned char *recvImageData_;
+
+
+uint64_t timeStampUs();
+
+// just some interactive text outputs
+void printInfo(int argc, char *argv[]);
+void printCompleteLicense(int argc, char* args[]);
+void printLicense(int argc, char* args[]);
+
+
+
+/**
+ *
+ * @param argc number of command line parameter
+ * @param *argv[] list of parameters
+ */
+int main(int argc, char *argv[]){
+
+	printInfo(argc,argv);
+
+	// client for image data, not reconnected: the recording ends with
+	// the connection
+	try{
+		dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_, 0);
+	}catch(string msg){
+		cerr << msg << endl << endl;
+		exit(1);
+	};
+	cout << "Server version: " << dataSource_->version() << endl;
+	cout << "META_DATA received: " << dataSource_->metaDataText() << endl;
+
+	recvImageData_ = new unsigned char[dataSource_->frameSize()];
+
+
+	FrameRecorder recorder;
+	try{
+		recorder.open(RECORDING_FILE_, dataSource_->version().c_str(), dataSource_->metaDataText().c_str(),
+				dataSource_->frameSize());
+	}catch(string msg){
+		cerr << msg << endl;
+		exit(1);
+	};
+
+	int status = 0;
+	while(dataSource_->receive(recvImageData_)){
+		try{
+			recorder.append(recvImageData_, timeStampUs());
+		}catch(string msg){
+			cerr << msg << endl;
+			status = 1;
+			break;
+		};
+
+		if((recorder.nmbFrames() % 100) == 0){
+			cout << recorder.nmbFrames() << " frames recorded\n";
+		};
+		if((MAX_FRAMES_ > 0) && (recorder.nmbFrames() >= MAX_FRAMES_)){
+			break;
+		};
+	};
+
+	if((MAX_FRAMES_ == 0) || (recorder.nmbFrames() < MAX_FRAMES_)){
+		cerr << "Server closed the connection.\n";
+	};
+	cout << recorder.nmbFrames() << " frames recorded into " << RECORDING_FILE_ << endl;
+	recorder.close();
+
+	delete dataSource_;
+	delete [] recvImageData_;
+	exit(status);
+};
+
+
+uint64_t timeStampUs(){
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return ((uint64_t) t.tv_sec) * 1000000 + t.tv_usec;
+};
+
+
+void printInfo(int argc, char *argv[]){
+		  if ((argc == 4) || (argc == 5)){
+			  SOURCE_SERVER_ADR_  = argv[1];
+			  SOURCE_SERVER_PORT_ = atoi(argv[2]);
+			  RECORDING_FILE_     = argv[3];
+			  if(argc == 5) MAX_FRAMES_ = atoi(argv[4]);
+			  return;
+		  }else if (argc == 2){
+			  printCompleteLicense(argc,argv);
+		  }else{     // Test for correct number of arguments
+		    cerr << "Usage of " << argv[0] << " : \n\n"
+		         << argv[0] << " <server host> <server port> <recording> [<frames>]" << endl;
+		    cerr << "\n"
+		    	 << "<server host>   hostname and port number of the \n"
+		    	 << "<server port>   running image data server \n"
+		    	 << "<recording>     file name of the recording, the index is\n"
+		    	 << "                written to <recording>.idx\n"
+		    	 << "<frames>        number of frames to record (default: until\n"
+		    	 << "                the server terminates)\n";
+		    printLicense(argc,argv);
+		    exit(1);
+		  };
+};
+
+void printLicense(int argc, char* args[]){
+	cout << endl;
+    cout << "" << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+    cout << "" << "This is free software, and you are welcome to redistribute it\n";
+    cout << "" << "under certain conditions; type: \n";
+    cout << "" << "'" << args[0] << " license' for details.\n\n";
+};
+
+
+
+void printCompleteLicense(int argc, char* args[]){
+	cout << endl;
+	cout << "\t"<< "This program is free software: you can redistribute it and/or modify \n";
+	cout << "\t"<< "it under the terms of the GNU General Public License as published by \n";
+	cout << "\t"<< "the Free Software Foundation, either version 3 of the License, or \n";
+	cout << "\t"<< "(at your option) any later version. \n\n";
+
+	cout << "\t"<< "This program is distributed in the hope that it will be useful, \n";
+	cout << "\t"<< "but WITHOUT ANY WARRANTY; without even the implied warranty of \n";
+	cout << "\t"<< "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the \n";
+	cout << "\t"<< "GNU General Public License for more details. \n\n";
+
+	cout << "\t"<< "You might have received a copy of the GNU General Public License \n";
+	cout << "\t"<< "along with this program.  If not, see <http://www.gnu.org/licenses/>. \n\n";
+
+	exit(0);
+};
@@ -34,6 +34,7 @@
 
 #include <iostream>           // For cerr and cout
 #include <cstdlib>            // For atoi()
+#include <cstring>            // For strcmp()
 #include <iostream>
 #include <math.h>
 #include <pthread.h>
@@ -47,6 +48,13 @@ using namespace cv;
 // communication
 #include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
 #include "../include/StdImgDataServerProtocol.H"  // For Socket, ServerSocket, and SocketException
+#include "../include/StdImgClient.H"
+
+// pixel kernels
+#include "../include/ImgKernels.H"
+#include "../include/BlobDetectorStage.H"
+#include "../include/StageServer.H"
+#include "../include/DisplayThread.H"
 
 
 // On Linux, you must compile with the -D_REENTRANT option.  This tells
@@ -56,38 +64,45 @@ using namespace cv;
 #endif
 
 
-// Set this to true to stop the threads
-// - The volatile keyword tells the compiler that this value may change at any
-//   time, since another thread may write to it, and that it should not be
-//   included in any optimizations.
-volatile bool bStop_ = true;
-volatile bool accessBlocked_ = false;
-
-TCPServerSocket *thisServer_;
-TCPSocket *dataSource_ = NULL;
+StageServer *thisServer_;
+StdImgClient *dataSource_ = NULL;
 
 unsigned short THIS_SERVER_PORT_;
 unsigned short SOURCE_SERVER_PORT_;
 char          *SOURCE_SERVER_ADR_;
 
-const int IMAGE_COLOR_ = 0;
-
+// the frame being processed while the next one is received
+const unsigned char *rawImageData_;
+int imageWidth_;
+int imageHeight_;
+int colorValue_;
 
-void *runServer(void * genericPtr);
-void HandleTCPClient(TCPSocket *sock);
+// the detector, its blob coordinates are served; the parameters are set
+// and read by SET_PARAM/GET_PARAM and the trackbar
+BlobDetectorStage *detector_ = NULL;
 
+// no window and no monitor image, just the served blob coordinates
+bool HEADLESS_ = false;
 
+// the window is updated by a thread of its own, at most DISPLAY_FPS_
+// times per second; a frame of the display holds the received image
+// followed by the scan result
+double DISPLAY_FPS_ = 30.0;
+DisplayThread *display_ = NULL;
 
-unsigned char *rawImageData_;
-unsigned char *monitorData_;
-int rawImageDataSize_;
-int imageWidth_;
-int imageHeight_;
-int colorValue_;
-unsigned char *blobCoord_;
-int blobCoordSize_ = 4;
+// the trackbar writes into a copy of the threshold on the display
+// thread, showDisplay() hands a change over by params().set(), under the
+// lock of the parameter table
+int trackbarThresh_ = 0;
+int appliedThresh_  = 0;
 
-int detectTrash_;
+// labeling threads for GET_BLOBS (0: one per CPU, 1: the processing
+// thread only), levels of the pyramid (0: none) and tracking, see
+// BlobDetectorStage
+int LABEL_THREADS_   = 1;
+int PYRAMID_LEVELS_  = 0;
+int TRACK_MARGIN_    = 0;
+int TRACK_BUDGET_    = 0;
 
 
 // image data raw data received (grey valued)
@@ -101,11 +116,14 @@ IplImage *openCvImageMinitor_;
 
 
 void printInfo(int argc, char *argv[]);
-int  sizeRawImageData(TCPSocket *socket, int *s, int *w, int *h, int *color);
-bool updateImageData(TCPSocket *socket,unsigned char *storageImageData, int size);
+void readOptions(int argc, char *argv[]);
 
 void createMonitorWin(char* winName,IplImage *openCvImg);
-void updateMonitor(IplImage *openCvImgMonitor,  unsigned char *imgD);
+void updateMonitor(unsigned char *view,  const unsigned char *imgD);
+void drawMonitor(IplImage *openCvImgMonitor, const unsigned char *imgD, const ImgKernels::BlobScanResult &scan,
+		const ScanWindow &window);
+void openDisplay(void *arg);
+void showDisplay(const unsigned char *view, void *arg);
 //void updateMonitor(IplImage *openCvImgRawData, IplImage *openCvImgMonitor);
 void updateRawImageView(IplImage *openCvImageRaw, unsigned char *imgD);
 
@@ -117,12 +135,13 @@ void updateRawImageView(IplImage *openCvImageRaw, unsigned char *imgD);
  */
 int main(int argc, char *argv[]){
 	printInfo(argc,argv);
+	readOptions(argc,argv);
 
 	// communication
 
 	// server for sending out the filter results
 	try {
-		thisServer_ = new TCPServerSocket(THIS_SERVER_PORT_); // Server Socket object
+		thisServer_ = new StageServer(THIS_SERVER_PORT_); // Server Socket object
 	}catch (SocketException &e) {
 		cerr << e.what() << endl;
 		exit(1);
@@ -130,62 +149,55 @@ int main(int argc, char *argv[]){
 
 	// client for getting the rgb data
 	try{
-		dataSource_ = new TCPSocket(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
-	}catch(...){
-		cout << "No server for image data.\n" << SOURCE_SERVER_ADR_ << endl << endl;
-		exit(1);
-	};
-	sizeRawImageData(dataSource_, &rawImageDataSize_, &imageWidth_,&imageHeight_,&colorValue_);
-	if(rawImageDataSize_ < 1){
-		cout << "No data available, check image data server.\n";
+		dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
+	}catch(string msg){
+		cout << msg << endl << endl;
 		exit(1);
 	};
-	printf("Receive image data %i x %i  total bytes %i \n", imageWidth_, imageHeight_, rawImageDataSize_);
+	imageWidth_  = dataSource_->metaData().width;
+	imageHeight_ = dataSource_->metaData().height;
+	colorValue_  = dataSource_->metaData().color;
+	printf("Receive image data %i x %i  total bytes %i \n", imageWidth_, imageHeight_, dataSource_->frameSize());
 
 	if(colorValue_ > 0){
 		cout << "Image data must be grey value data.\n";
 		exit(1);
 	};
 
-	rawImageData_ = new unsigned char[rawImageDataSize_];
-	monitorData_  = new unsigned char[imageWidth_*imageHeight_]; // no RGB, just grey values
-	blobCoord_    = new unsigned char[blobCoordSize_];
+	detector_ = new BlobDetectorStage(imageWidth_, imageHeight_, LABEL_THREADS_, PYRAMID_LEVELS_);
+	detector_->track(TRACK_MARGIN_, TRACK_BUDGET_);
 
 	//view
-	winNameMonitor_ = new char[16]; sprintf(winNameMonitor_,"Blob Detector");
-	openCvImageMinitor_ = cvCreateImage(cvSize(imageWidth_,imageHeight_),IPL_DEPTH_8U,3);
-	createMonitorWin(winNameMonitor_,openCvImageMinitor_);
-	cvCreateTrackbar("thrash value" ,winNameMonitor_, &detectTrash_, 255, NULL );
-
-	openCvImageRawGrey_ = cvCreateImage(cvSize(imageWidth_,imageHeight_),IPL_DEPTH_8U,1);
-
+	if(!HEADLESS_){
+		display_ = new DisplayThread(imageWidth_*imageHeight_ + sizeof(ImgKernels::BlobScanResult) + sizeof(ScanWindow),
+				DISPLAY_FPS_, openDisplay, showDisplay, NULL);
+		display_->start();
+	};
 
 
-    // organize threads
-    pthread_t serverID;
-    pthread_create(&serverID,NULL,runServer,NULL);
-    bStop_ = false; // start threads
 
+	// the server runs until the process ends, the detector is never deleted
+	thisServer_->start(detector_);
 
 
-	int i=0;
-	while(updateImageData(dataSource_,rawImageData_,rawImageDataSize_)){
+	// the next frame is received while this one is processed
+	dataSource_->startReceiving();
+	while((rawImageData_ = dataSource_->nextFrame()) != NULL){
 		//updateRawImageView(openCvImageRawGrey_,rawImageData_);
-		accessBlocked_ = true;
-		updateMonitor(openCvImageMinitor_,rawImageData_);
-		accessBlocked_ = false;
-		cvShowImage(winNameMonitor_,openCvImageMinitor_);
-		cvWaitKey(2);
-	};
-
-	pthread_yield();
-	bStop_ = true;
-	pthread_join(serverID, NULL);
 
+		// no frame for the display if it still holds all buffers
+		unsigned char *view = (display_ != NULL) ? display_->writeBuffer() : NULL;
+		detector_->lock();
+		updateMonitor(view,rawImageData_);
+		detector_->processed();
+		detector_->unlock();
+		if(view != NULL){
+			display_->publish();
+		};
+	};
 
+	delete display_;
 	delete dataSource_;
-	delete [] rawImageData_;
-	delete [] monitorData_;
 	exit(0);
 };
 
@@ -201,115 +213,54 @@ void updateRawImageView(IplImage *openCvImageRaw, unsigned char *imgD){
 */
 
 
-	for(int i = 0; i < imageHeight_; i++){
-		for(int j = 0; j < imageWidth_; j++){
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 0] =
-						imgD[(imageWidth_*i) + j]; // B
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 1] =
-						imgD[(imageWidth_*i) + j]; // G
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 2] =
-						imgD[(imageWidth_*i) + j]; // R
-		};
-	};
+	ImgKernels::greyToBgr(imgD, (uchar *) openCvImageRaw->imageData, openCvImageRaw->widthStep, openCvImageRaw->nChannels,
+			imageWidth_, imageHeight_);
 }
 
-void updateMonitor(IplImage *openCvImgMonitor,  unsigned char *imgD){
-
-	/*
-	// transfer raw data into the monitor image data
-	for(int i = 0; i < imageHeight_; i++){
-		for(int j = 0; j < imageWidth_; j++){
-			((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j] =
-					((uchar *)(openCvImgRawData->imageData + i*openCvImgRawData->widthStep))[j];
-		};
-	};
-	*/
-
-	// write data into image structure to display image
-	for(int i = 0; i < imageHeight_; i++){
-		for(int j = 0; j < imageWidth_; j++){
-				((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j*openCvImgMonitor->nChannels + 0] =
-						imgD[(imageWidth_*i) + j]; // B
-				((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j*openCvImgMonitor->nChannels + 1] =
-						imgD[(imageWidth_*i) + j]; // G
-				((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j*openCvImgMonitor->nChannels + 2] =
-						imgD[(imageWidth_*i) + j]; // R
-		};
-	};
-
-
-	int value, w, h, maxH, minH, maxW, minW, meanW, meanH;
-
-	// find maximal height value
-	maxH = -1;
-	for(int i = 0; i < imageHeight_; i++){
-		for(int j = 0; j < imageWidth_; j++){
-			value = imgD[(imageWidth_*i) + j];
-			//value = ((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j];
-			if(value > detectTrash_){
-				cvCircle(openCvImgMonitor, cvPoint(j,i), 10, cvScalar(255,255,255), 2, 8);
-				w = j;
-				h = i;
-				maxH = h;
-				i=imageHeight_;
-				j=imageWidth_;
-			}
-		};
-	};
+void openDisplay(void *arg){
+	winNameMonitor_ = new char[16]; sprintf(winNameMonitor_,"Blob Detector");
+	openCvImageMinitor_ = cvCreateImage(cvSize(imageWidth_,imageHeight_),IPL_DEPTH_8U,3);
+	createMonitorWin(winNameMonitor_,openCvImageMinitor_);
+	detector_->params().lock();
+	trackbarThresh_ = *detector_->threshold();
+	detector_->params().unlock();
+	appliedThresh_ = trackbarThresh_;
+	cvCreateTrackbar("thrash value" ,winNameMonitor_, &trackbarThresh_, 255, NULL );
+}
 
-	// find maximal height value
-	minH = -1;
-	for(int i =imageHeight_-1; i > -1; i--){
-		for(int j = imageWidth_; j > -1 ; j--){
-			value = imgD[(imageWidth_*i) + j];
-			//value = ((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j];
-			if(value > detectTrash_){
-				cvCircle(openCvImgMonitor, cvPoint(j,i), 10, cvScalar(255,255,255), 2, 8);
-				w = j;
-				h = i;
-				minH = h;
-				i=-1;
-				j=-1;
-			}
-		};
+void showDisplay(const unsigned char *view, void *arg){
+	if(view != NULL){
+		ImgKernels::BlobScanResult scan;
+		ScanWindow window;
+		memcpy(&scan, view + imageWidth_*imageHeight_, sizeof(scan));
+		memcpy(&window, view + imageWidth_*imageHeight_ + sizeof(scan), sizeof(window));
+		drawMonitor(openCvImageMinitor_, view, scan, window);
+		cvShowImage(winNameMonitor_,openCvImageMinitor_);
 	};
-
-
-	// find maximal width value
-	maxW = -1;
-	for(int i = 0; i < imageWidth_; i++){
-		for(int j = 0; j < imageHeight_; j++){
-			value = imgD[(imageWidth_*j) + i];
-			//value = ((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j];
-			if(value > detectTrash_){
-				cvCircle(openCvImgMonitor, cvPoint(i,j), 10, cvScalar(255,255,255), 2, 8);
-				h = j;
-				w = i;
-				maxW = w;
-				i=imageWidth_;
-				j=imageHeight_;
-			}
-		};
+	cvWaitKey(1);
+	if(trackbarThresh_ != appliedThresh_){
+		char assignment[32];
+		sprintf(assignment, "detectThresh=%d", trackbarThresh_);
+		detector_->params().set(assignment);
+		appliedThresh_ = trackbarThresh_;
 	};
+}
 
-	// find maximal width value
-	minW = -1;
-	for(int i = imageWidth_; i > -1 ; i--){
-		for(int j = imageHeight_; j > -1 ; j--){
-			value = imgD[(imageWidth_*j) + i];
-			//value = ((uchar *)(openCvImgMonitor->imageData + i*openCvImgMonitor->widthStep))[j];
-			if(value > detectTrash_){
-				cvCircle(openCvImgMonitor, cvPoint(i,j), 10, cvScalar(255,255,255), 2, 8);
-				h = j;
-				w = i;
-				minW = w;
-				i=-1;
-				j=-1;
-			}
-		};
-	};
+void drawMonitor(IplImage *openCvImgMonitor, const unsigned char *imgD, const ImgKernels::BlobScanResult &scan,
+		const ScanWindow &window){
+	// write data into image structure to display image
+	ImgKernels::greyToBgr(imgD, (uchar *) openCvImgMonitor->imageData, openCvImgMonitor->widthStep, openCvImgMonitor->nChannels,
+			imageWidth_, imageHeight_);
 
+	int maxH = scan.firstRow;
+	int minH = scan.lastRow;
+	int maxW = scan.firstCol;
+	int minW = scan.lastCol;
 
+	if(maxH > -1) cvCircle(openCvImgMonitor, cvPoint(scan.firstRowX,scan.firstRow), 10, cvScalar(255,255,255), 2, 8);
+	if(minH > -1) cvCircle(openCvImgMonitor, cvPoint(scan.lastRowX,scan.lastRow), 10, cvScalar(255,255,255), 2, 8);
+	if(maxW > -1) cvCircle(openCvImgMonitor, cvPoint(scan.firstCol,scan.firstColY), 10, cvScalar(255,255,255), 2, 8);
+	if(minW > -1) cvCircle(openCvImgMonitor, cvPoint(scan.lastCol,scan.lastColY), 10, cvScalar(255,255,255), 2, 8);
 
 	cvLine(openCvImgMonitor, cvPoint(0,maxH),cvPoint(imageWidth_,maxH), cvScalar(255,0,0), 2, 8);
 	cvLine(openCvImgMonitor, cvPoint(0,minH),cvPoint(imageWidth_,minH), cvScalar(0,0,255), 2, 8);
@@ -317,63 +268,35 @@ void updateMonitor(IplImage *openCvImgMonitor,  unsigned char *imgD){
 	cvLine(openCvImgMonitor, cvPoint(maxW,0),cvPoint(maxW, imageHeight_), cvScalar(255,0,0), 2, 8);
 	cvLine(openCvImgMonitor, cvPoint(minW,0),cvPoint(minW, imageHeight_), cvScalar(0,0,255), 2, 8);
 
+	// centroid of all pixels above the threshold
+	if(scan.count > 0){
+		cvCircle(openCvImgMonitor, cvPoint((int) (scan.sumX / scan.count), (int) (scan.sumY / scan.count)), 4,
+				cvScalar(0,255,0), 2, 8);
+	};
 
-	if( ((maxW < 0) && (minW < 0)) ||
-		((maxH < 0) && (minH < 0))	){
-		blobCoord_[0] = 0;
-		blobCoord_[1] = 0;
-		blobCoord_[2] = 0;
-		blobCoord_[3] = 0;
-	}else{
-		if(maxW < minW){
-			int tmp;
-			tmp = maxW;
-			maxW = minW;
-			minW = tmp;
-		}
-		if(maxH < minH){
-			int tmp;
-			tmp = maxH;
-			maxH = minH;
-			minH = tmp;
-		}
-
-		meanW = ((maxW - minW) / 2) + minW;
-		meanH = ((maxH - minH) / 2) + minH;
-
-
-		blobCoord_[0] = ((int)0xFF)   & meanW;  // 1st 8 bits of meanW
-		blobCoord_[1] = (((int)0xFF00) & meanW) >> 8 ;  // 2nd 8 bits of meanW
-		blobCoord_[2] = ((int)0xFF)   & meanH;  // 1st 8 bits of meanH
-		blobCoord_[3] = (((int)0xFF00) & meanH) >> 8;  // 2nd 8 bits of meanH
-
-		cout << "width: " << meanW  << "    height: " << meanH << endl;
-
-		int bloobCoordWidth = 0;
-		int bloobCoordHight = 0;
-
-		bloobCoordWidth = (int) (blobCoord_[1]);
-		bloobCoordWidth = bloobCoordWidth << 8;
-		bloobCoordWidth = bloobCoordWidth   | ((int) blobCoord_[0]);
-
-		bloobCoordHight = (int) (blobCoord_[3]);
-		bloobCoordHight = bloobCoordHight << 8;
-		bloobCoordHight = bloobCoordHight   | ((int) blobCoord_[2]);
-
-		//printf("HEX: %08x \t-->\t %08x - %08x\n", meanW, blobCoord_[0], blobCoord_[1]);
-
-
-		//cout << "CALC: width: " << bloobCoordWidth  << "    height: " << bloobCoordHight << endl;
-
-	}
-
-
-
-
+	// the part of the image searched
+	if((window.x1 - window.x0 < imageWidth_) || (window.y1 - window.y0 < imageHeight_)){
+		cvRectangle(openCvImgMonitor, cvPoint(window.x0,window.y0), cvPoint(window.x1 - 1,window.y1 - 1),
+				cvScalar(0,255,255), 1, 8);
+	};
+}
 
-	// find minimal height value
+void updateMonitor(unsigned char *view,  const unsigned char *imgD){
+	detector_->process(imgD);
 
+	// image and scan result for the display, drawn by the display thread
+	if(view != NULL){
+		ImgKernels::BlobScanResult scan = detector_->scan();
+		ScanWindow window = detector_->window();
+		memcpy(view, imgD, imageWidth_*imageHeight_);
+		memcpy(view + imageWidth_*imageHeight_, &scan, sizeof(scan));
+		memcpy(view + imageWidth_*imageHeight_ + sizeof(scan), &window, sizeof(window));
+	};
 
+	int meanW, meanH;
+	if(detector_->blobCoord(&meanW, &meanH)){
+		cout << "width: " << meanW  << "    height: " << meanH << endl;
+	};
 };
 
 void createMonitorWin(char* winName,IplImage *openCvImg){
@@ -381,47 +304,23 @@ void createMonitorWin(char* winName,IplImage *openCvImg){
 	cvShowImage(winName,openCvImg);
 };
 
-int  sizeRawImageData(TCPSocket *socket, int *s, int *w, int *h, int *color){
-	int rcvBufferSize = 124;
-	char echoBuffer[rcvBufferSize];
-	int bytesReceived = 0;
-	socket->send("GET_META_DATA",strlen("GET_META_DATA"));
-	if( (bytesReceived = socket->recv(echoBuffer,rcvBufferSize)) <= 0){
-		return (-1);
-	};
-
-	// interprete received data
-	char ch1,ch2,ch3,imageOrg;
-	int  recvImageDataSize, nmbBytesTimeStamp;
-	int nmbTokens = sscanf(echoBuffer,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
-			w,h,&imageOrg,color,&ch1,&ch2,&ch3,&recvImageDataSize,&nmbBytesTimeStamp);
-	if(nmbTokens != 9){
-		cerr << "Can't interprete image meta data, terminate process.\n";
-		return (-1);
-	};
-	*s = recvImageDataSize + nmbBytesTimeStamp;
-	return *s;
-};
-
-bool updateImageData(TCPSocket *socket,unsigned char *storageImageData, int size){
-	int rcvBufferSize = size;
-	int idx = 0;
-	int bytesReceived = 0;
-	int totalBytesReceived = 0;
-	socket->send("GET_IMAGE_DATA",strlen("GET_IMAGE_DATA"));
-	do{
-		bytesReceived = socket->recv(&(storageImageData[idx]),rcvBufferSize);
-		totalBytesReceived += bytesReceived;
-		idx = totalBytesReceived;
-	}while(totalBytesReceived < size);
-	return true;
-};
-
-
 void printInfo(int argc, char *argv[]){
-		  if (argc != 4){     // Test for correct number of arguments
+		  if (argc < 4){     // Test for correct number of arguments
 		    cerr << "Usage: " << argv[0]
-		         << " <Port of this server> <Server of Data> <Port of Server of Data>" << endl;
+		         << " <Port of this server> <Server of Data> <Port of Server of Data> [options]" << endl;
+		    cerr << "\n"
+		         << "options:\n"
+		         << "--headless      no window, the threshold is set by SET_PARAM\n"
+		         << "-displayFps <f> refresh rate cap of the window (default 30)\n"
+		         << "-threads <n>    threads labeling the blobs of GET_BLOBS (default 1,\n"
+		         << "                0: one per CPU)\n"
+		         << "-track <m>      search the blob within its last bounding box grown by m\n"
+		         << "                pixels, the whole image only if lost (default 0: off)\n"
+		         << "-trackBudget <r> search a lost blob in bands of r rows per frame\n"
+		         << "                (default 0: the whole image at once)\n"
+		         << "-pyramid <l>    pyramid of 2^l x 2^l blocks for the frames labeled for\n"
+		         << "                GET_BLOBS only, speeds up their labeling (default 0:\n"
+		         << "                off), other frames are scanned without\n";
 		    exit(1);
 		  };
 
@@ -430,154 +329,27 @@ void printInfo(int argc, char *argv[]){
 		  THIS_SERVER_PORT_   = atoi(argv[1]);
 };
 
-
-
-void HandleTCPClient(TCPSocket *sock){
-  cout << "Handling central unit\n";
-  try {
-    cout << sock->getForeignAddress() << ":";
-  } catch (SocketException &e) {
-    cerr << "Unable to get foreign address" << endl;
-  }
-  try {
-    cout << sock->getForeignPort();
-  } catch (SocketException &e) {
-    cerr << "Unable to get foreign port" << endl;
-  }
-  cout << endl;
-  // Send received string and receive again until the end of transmission
-  int revBUFFER_SIZE = 100;
-
-  char revBuffer[revBUFFER_SIZE];
-  int recvMsgSize;
-
-  char echoMetaData[124];
-  char echoUnknownCommand[1024];
-
-  do{
-    try{
-    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
-    	if(recvMsgSize < 1) break;
-    }catch(...){
-    	break;
-    };
-
-
-    if(!(strncmp(GET_META_DATA,revBuffer,strlen(GET_META_DATA)))){
-    	// send meta data
-    	echoMetaData[0]='\0';
-    	sprintf(echoMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]%c",
-    			blobCoordSize_,1,'W',0,'X','X','X',blobCoordSize_,0,'\0');
-    	sock->send(echoMetaData,strlen(echoMetaData));
-    }else if(!(strncmp("GET_IMAGE_DATA",revBuffer,strlen(GET_IMAGE_DATA)))){
-    	// send image data
-		do{
-			if(!accessBlocked_){
-				sock->send(blobCoord_,blobCoordSize_);
-				break;
-			}else{
-				//cout << "access blocked continue request.\n";
-			};
-		}while(true);
-    }else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
-    	echoMetaData[0]='\0';
-    	sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
-    	sock->send(echoMetaData,strlen(echoMetaData));
-    }else{
-    	// send protocol
-    	echoUnknownCommand[0]='\0';
-    	sprintf(echoUnknownCommand,"%s please try:\n %s\n %s\n %s\n%c",UNKNOWN_COMMAND, GET_VERSION, GET_META_DATA, GET_IMAGE_DATA,'\0');
-		sock->send(echoUnknownCommand, strlen(echoUnknownCommand));
-    };
-  }while(true);
-
-  delete sock;
-
-};
-
-/*
-
-void HandleTCPClient(TCPSocket *sock){
-	  cout << "Handling central unit\n";
-	  try {
-	    cout << sock->getForeignAddress() << ":";
-	  } catch (SocketException &e) {
-	    cerr << "Unable to get foreign address" << endl;
-	  }
-	  try {
-	    cout << sock->getForeignPort();
-	  } catch (SocketException &e) {
-	    cerr << "Unable to get foreign port" << endl;
-	  }
-	  cout << endl;
-	  // Send received string and receive again until the end of transmission
-	  int revBUFFER_SIZE = 100;
-
-	  char revBuffer[revBUFFER_SIZE];
-	  int recvMsgSize;
-	  bool correct;
-
-	  do{
-	    try{
-	    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
-	    	if(recvMsgSize < 1) break;
-	    	revBuffer[recvMsgSize]='\0';
-	    }catch(...){
-	    	break;
-	    };
-
-	    printf(" msg: %s \n", revBuffer);
-
-	    if(!(strncmp("NUMBER_BYTES",revBuffer,strlen("NUMBER_BYTES")))){
-	    	correct=true;
-	    	// send size
-	    	char echo[64];
-	    	sprintf(echo,"%d=[w=%d,h=%d]",(imageWidth_*imageHeight_), imageWidth_,imageHeight_);
-	    	sock->send(echo,strlen(echo));
-	    }else if(!(strncmp("FILTER_DATA",revBuffer,strlen("FILTER_DATA")))){
-			do{
-				if(!accessBlocked_){
-					sock->send(sumFilterData_,(imageWidth_*imageHeight_));
-					break;
-				}else{
-					cout << "\t\t access blocked continue request.\n";
-				};
-			}while(true);
-	    }else{
-	    	correct=false;
-			sock->send("-1001", 20);
-	    };
-	  }while(true);
-
-	  delete sock;
-
-};
-*/
-
-void *runServer(void * genericPtr){
-	//cout << "+WAIT"; cout.flush();
-	while(bStop_){;};  // wait
-	pthread_yield();
-
-	//cout << "YES left \n"; cout.flush();
-	int i = 0;
-	try{
-		do{   // Run forever
-			HandleTCPClient(thisServer_->accept());       // Wait for a client to connect
-	    }while(!bStop_);
-	}catch (SocketException &e) {
-	    cerr << e.what() << endl;
+void readOptions(int argc, char *argv[]){
+	for(int i = 4; i < argc; i++){
+		if(!strcmp(argv[i], "--headless")){
+			HEADLESS_ = true;
+		}else if(i+1 == argc){
+			cerr << "No value of option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		}else if(!strcmp(argv[i], "-displayFps")){
+			DISPLAY_FPS_ = atof(argv[++i]);
+		}else if(!strcmp(argv[i], "-threads")){
+			LABEL_THREADS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-track")){
+			TRACK_MARGIN_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-trackBudget")){
+			TRACK_BUDGET_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-pyramid")){
+			PYRAMID_LEVELS_ = atoi(argv[++i]);
+		}else{
+			cerr << "Unknown option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		};
 	};
-	// Relenquish the CPU for another thread
-	pthread_yield();
-
-	delete thisServer_;
-	bStop_ = true;
-	return NULL;
 };
 
-
-
-
-
-
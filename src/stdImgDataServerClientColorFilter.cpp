@@ -34,6 +34,7 @@
 
 #include <iostream>           // For cerr and cout
 #include <cstdlib>            // For atoi()
+#include <cstring>            // For memcmp() and strcmp()
 #include <iostream>
 #include <math.h>
 #include <pthread.h>
@@ -47,6 +48,13 @@ using namespace cv;
 // communication
 #include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
 #include "../include/StdImgDataServerProtocol.H"  // For Socket, ServerSocket, and SocketException
+#include "../include/StdImgClient.H"
+
+// pixel kernels
+#include "../include/ImgKernels.H"
+#include "../include/ColorFilterStage.H"
+#include "../include/StageServer.H"
+#include "../include/DisplayThread.H"
 
 
 // On Linux, you must compile with the -D_REENTRANT option.  This tells
@@ -56,31 +64,15 @@ using namespace cv;
 #endif
 
 
-// Set this to true to stop the threads
-// - The volatile keyword tells the compiler that this value may change at any
-//   time, since another thread may write to it, and that it should not be
-//   included in any optimizations.
-volatile bool bStop_ = true;
-volatile bool accessBlocked_ = false;
-
-TCPServerSocket *thisServer_;
-TCPSocket *dataSource_ = NULL;
+StageServer *thisServer_;
+StdImgClient *dataSource_ = NULL;
 
 unsigned short THIS_SERVER_PORT_;
 unsigned short SOURCE_SERVER_PORT_;
 char          *SOURCE_SERVER_ADR_;
 
-const int CAMERA_COLOR_ = 0;
-
-
-void *runServer(void * genericPtr);
-void HandleTCPClient(TCPSocket *sock);
-
-
-
-unsigned char *rawImageData_;
-unsigned char *sumFilterData_;
-int rawImageDataSize_;
+// the frame being filtered while the next one is received
+const unsigned char *rawImageData_;
 int imageWidth_;
 int imageHeight_;
 
@@ -100,30 +92,49 @@ IplImage *openCvImageRfilter_;
 char* winNameGfilter_;
 IplImage *openCvImageGfilter_;
 
-int rFilterThreshR_ = 162;
-int rFilterThreshG_ = 143;
-int rFilterThreshB_ = 255;
-int gFilterThreshR_ = 126;
-int gFilterThreshG_ = 140;
-int gFilterThreshB_ = 209;
-int bFilterThreshR_ = 87;
-int bFilterThreshG_ = 255;
-int bFilterThreshB_ = 149;
-
-int sumPartB_ = 0;
-int sumPartG_ = 0;
-int sumPartR_ = 0;
-int sumAdd_   = 0;
+// the filter, its sum is served; the parameters are set and read by
+// SET_PARAM/GET_PARAM and the trackbars
+ColorFilterStage *filter_ = NULL;
+
+// no windows and no filter images, just the served sum
+bool HEADLESS_ = false;
+
+// the windows are updated by a thread of their own, at most
+// DISPLAY_FPS_ times per second; a frame of the display holds the
+// received RGB image followed by the R, G, B and sum filter planes
+double DISPLAY_FPS_ = 30.0;
+DisplayThread *display_ = NULL;
+
+// the filter runs on row bands of a pool of threads
+int FILTER_THREADS_ = 0;    // 0: one per CPU
+int FILTER_LUT_     = 0;    // 1: classify by lookup tables
+
+// the trackbars write into copies of the parameters on the display
+// thread, showDisplay() hands the changes over by params().set(), under
+// the lock of the parameter table
+struct Trackbar{
+	const char *param;     // name in the parameter table
+	int         value;     // written by the trackbar
+	int         applied;   // last value handed over
+};
+#define NMB_TRACKBARS 13
+Trackbar trackbars_[NMB_TRACKBARS];
+int      nmbTrackbars_ = 0;
 
 
 
 void printInfo(int argc, char *argv[]);
-int  sizeRawImageData(TCPSocket *socket, int *s, int *w, int *h);
-bool updateImageData(TCPSocket *socket,unsigned char *storageImageData, int size);
-void updateRawImageView(IplImage *openCvImageRaw, unsigned char *imgD);
+void readOptions(int argc, char *argv[]);
+void updateRawImageView(IplImage *openCvImageRaw, const unsigned char *imgD);
 
 void createColorFilterWin(char color, char* winName,IplImage *openCvImg);
-void updateFilters(IplImage *openCvImgR,IplImage *openCvImgG,IplImage *openCvImgB,IplImage *openCvImgSum);
+void createTrackbar(const char *label, char *winName, const char *param, const int *setting, int max);
+void applyTrackbars();
+void updateFilters(unsigned char *view);
+
+unsigned char *viewPlane(unsigned char *view, int plane);
+void openDisplay(void *arg);
+void showDisplay(const unsigned char *view, void *arg);
 
 /**
  *
@@ -132,12 +143,13 @@ void updateFilters(IplImage *openCvImgR,IplImage *openCvImgG,IplImage *openCvImg
  */
 int main(int argc, char *argv[]){
 	printInfo(argc,argv);
+	readOptions(argc,argv);
 
 	// communication
 
 	// server for sending out the filter results
 	try {
-		thisServer_ = new TCPServerSocket(THIS_SERVER_PORT_); // Server Socket object
+		thisServer_ = new StageServer(THIS_SERVER_PORT_); // Server Socket object
 	}catch (SocketException &e) {
 		cerr << e.what() << endl;
 		exit(1);
@@ -145,22 +157,59 @@ int main(int argc, char *argv[]){
 
 	// client for getting the rgb data
 	try{
-		dataSource_ = new TCPSocket(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
-	}catch(...){
-		cout << "No server for image data.\n" << SOURCE_SERVER_ADR_ << endl << endl;
+		dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
+	}catch(string msg){
+		cout << msg << endl << endl;
 		exit(1);
 	};
-	sizeRawImageData(dataSource_, &rawImageDataSize_, &imageWidth_,&imageHeight_);
-	if(rawImageDataSize_ < 1){
-		cout << "No data available, check image data server.\n";
-		exit(1);
-	};
-	printf("Receive image data %i x %i  total bytes %i \n", imageWidth_, imageHeight_, rawImageDataSize_);
+	imageWidth_  = dataSource_->metaData().width;
+	imageHeight_ = dataSource_->metaData().height;
+	printf("Receive image data %i x %i  total bytes %i \n", imageWidth_, imageHeight_, dataSource_->frameSize());
 
-	rawImageData_ = new unsigned char[rawImageDataSize_];
-	sumFilterData_ = new unsigned char[imageWidth_*imageHeight_]; // no RGB, just grey values
+	filter_ = new ColorFilterStage(imageWidth_, imageHeight_, FILTER_THREADS_, FILTER_LUT_ != 0);
+	printf("Color filter on %i thread(s)\n", filter_->nmbThreads());
 
 	//view
+	if(!HEADLESS_){
+		display_ = new DisplayThread(7*imageWidth_*imageHeight_, DISPLAY_FPS_, openDisplay, showDisplay, NULL);
+		display_->start();
+	};
+
+	// the server runs until the process ends, the filter is never deleted
+	thisServer_->start(filter_);
+
+
+	// the next frame is received while this one is filtered
+	dataSource_->startReceiving();
+	while((rawImageData_ = dataSource_->nextFrame()) != NULL){
+
+		// no frame for the display if it still holds all buffers
+		unsigned char *view = (display_ != NULL) ? display_->writeBuffer() : NULL;
+		filter_->lock();
+		updateFilters(view);
+		filter_->processed();
+		filter_->unlock();
+		if(view != NULL){
+			memcpy(view, rawImageData_, 3*imageWidth_*imageHeight_);
+			display_->publish();
+		};
+	};
+
+	delete display_;
+	delete dataSource_;
+	exit(0);
+};
+
+void updateRawImageView(IplImage *openCvImageRaw, const unsigned char *imgD){
+	ImgKernels::rgbToBgr(imgD, (uchar *) openCvImageRaw->imageData, openCvImageRaw->widthStep, openCvImageRaw->nChannels,
+			imageWidth_, imageHeight_);
+}
+
+unsigned char *viewPlane(unsigned char *view, int plane){
+	return view + (3 + plane)*imageWidth_*imageHeight_;
+}
+
+void openDisplay(void *arg){
 	winNameRfilter_ = new char[16]; sprintf(winNameRfilter_,"%c filter",'R');
 	openCvImageRfilter_ = cvCreateImage(cvSize(imageWidth_,imageHeight_),IPL_DEPTH_8U,1);
 	createColorFilterWin('R',winNameRfilter_,openCvImageRfilter_);
@@ -182,171 +231,100 @@ int main(int argc, char *argv[]){
 	winNameRawRGB_ = new char[32];
 	strcpy(winNameRawRGB_, "Received Image");
 	cvNamedWindow(winNameRawRGB_, 0);
+}
 
-
-
-    // organize threads
-    pthread_t serverID;
-    pthread_create(&serverID,NULL,runServer,NULL);
-    bStop_ = false; // start threads
-
-
-
-	int i=0;
-	while(updateImageData(dataSource_,rawImageData_,rawImageDataSize_)){
-
-		updateRawImageView(openCvImageRawRGB_,rawImageData_);
-		accessBlocked_ = true;
-		updateFilters(openCvImageRfilter_,openCvImageGfilter_,openCvImageBfilter_,openCvImageSumFilter_);
-		accessBlocked_ = false;
+void showDisplay(const unsigned char *view, void *arg){
+	if(view != NULL){
+		unsigned char *v = (unsigned char *) view;
+		updateRawImageView(openCvImageRawRGB_, v);
+		ImgKernels::greyToPlane(viewPlane(v,0), (uchar *) openCvImageRfilter_->imageData, openCvImageRfilter_->widthStep,
+				imageWidth_, imageHeight_);
+		ImgKernels::greyToPlane(viewPlane(v,1), (uchar *) openCvImageGfilter_->imageData, openCvImageGfilter_->widthStep,
+				imageWidth_, imageHeight_);
+		ImgKernels::greyToPlane(viewPlane(v,2), (uchar *) openCvImageBfilter_->imageData, openCvImageBfilter_->widthStep,
+				imageWidth_, imageHeight_);
+		ImgKernels::greyToPlane(viewPlane(v,3), (uchar *) openCvImageSumFilter_->imageData, openCvImageSumFilter_->widthStep,
+				imageWidth_, imageHeight_);
 		cvShowImage(winNameRawRGB_,openCvImageRawRGB_);
 		cvShowImage(winNameRfilter_,openCvImageRfilter_);
 		cvShowImage(winNameGfilter_,openCvImageGfilter_);
 		cvShowImage(winNameBfilter_,openCvImageBfilter_);
 		cvShowImage(winNameSumFilter_,openCvImageSumFilter_);
-		cvWaitKey(2);
-	};
-
-	pthread_yield();
-	bStop_ = true;
-	pthread_join(serverID, NULL);
-
-
-	delete dataSource_;
-	delete [] rawImageData_;
-	delete [] sumFilterData_;
-	exit(0);
-};
-
-void updateRawImageView(IplImage *openCvImageRaw, unsigned char *imgD){
-	for(int i = 0; i < imageHeight_; i++){
-		for(int j = 0; j < imageWidth_; j++){
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 0] =
-					imgD[3*((imageWidth_*i) + j) + 2]; // B
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 1] =
-					imgD[3*((imageWidth_*i) + j) + 1]; // G
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 2] =
-					imgD[3*((imageWidth_*i) + j) + 0]; // R
-		};
 	};
-
+	cvWaitKey(1);
+	applyTrackbars();
 }
-void updateFilters(IplImage *openCvImgR,IplImage *openCvImgG,IplImage *openCvImgB,IplImage *openCvImgSum){
-	unsigned int valueR, valueB, valueG, sum;
-	unsigned int bFilteredValue, rFilteredValue, gFilteredValue;
-	float relSumPartB, relSumPartG, relSumPartR;
-
-	int i;
-	for(int w = 0; w < imageWidth_; w++){
-		for(int h = 0; h < imageHeight_; h++){
-
-			i = ((imageWidth_*h) + w);
-			valueR = (unsigned int) rawImageData_[3*i];
-			valueG = (unsigned int) rawImageData_[3*i+1];
-			valueB = (unsigned int) rawImageData_[3*i+2];
-
-			if( ( valueR > rFilterThreshR_ ) &&
-					( valueG < rFilterThreshG_ ) &&
-					( valueB < rFilterThreshB_ )    ){
-				rFilteredValue = valueR ;
-			}else{
-				rFilteredValue = 0;
-			};
-			if( ( valueG > gFilterThreshG_ ) &&
-					( valueR < gFilterThreshR_ ) &&
-					( valueB < gFilterThreshB_ )    ){
-				gFilteredValue = valueG ;
-			}else{
-				gFilteredValue = 0;
-			};
-			if( ( valueB > bFilterThreshB_ ) &&
-					( valueG < bFilterThreshG_ ) &&
-					( valueR < bFilterThreshR_ )    ){
-				bFilteredValue = valueB ;
-			}else{
-				bFilteredValue = 0;
-			};
-
-			((uchar *)(openCvImgR->imageData + h*openCvImgR->widthStep))[w] = rFilteredValue;
-			((uchar *)(openCvImgG->imageData + h*openCvImgG->widthStep))[w] = gFilteredValue;
-			((uchar *)(openCvImgB->imageData + h*openCvImgB->widthStep))[w] = bFilteredValue;
-
-			relSumPartB = (((float) sumPartB_)/100.0 )*((float) bFilteredValue);
-			relSumPartG = (((float) sumPartG_)/100.0 )*((float) gFilteredValue);
-			relSumPartR = (((float) sumPartR_)/100.0 )*((float) rFilteredValue);
-			sum = (unsigned int) (relSumPartB + relSumPartG + relSumPartR + sumAdd_);
-			if(sum > 255) sum = 255;
-
-			((uchar *)(openCvImgSum->imageData + h*openCvImgSum->widthStep))[w] = sum;
-			sumFilterData_[i] = (unsigned char) sum;
-		};
+
+void updateFilters(unsigned char *view){
+	// the filter planes of the display frame, if any
+	if(view != NULL){
+		filter_->filter(rawImageData_, viewPlane(view,0), viewPlane(view,1), viewPlane(view,2), viewPlane(view,3));
+	}else{
+		filter_->process(rawImageData_);
 	};
 };
 
 void createColorFilterWin(char color, char* winName,IplImage *openCvImg){
+	ImgKernels::ColorFilterParams *p = filter_->settings();
 	cvNamedWindow(winName, 0);
 	cvShowImage(winName,openCvImg);
 	if(color == 'R'){
-		cvCreateTrackbar("R >",winName, &rFilterThreshR_, 255, NULL );
-		cvCreateTrackbar("G <",winName, &rFilterThreshG_, 255, NULL );
-		cvCreateTrackbar("B <",winName, &rFilterThreshB_, 255, NULL );
+		createTrackbar("R >",winName, "rFilterThreshR", &p->rFilterThreshR, 255);
+		createTrackbar("G <",winName, "rFilterThreshG", &p->rFilterThreshG, 255);
+		createTrackbar("B <",winName, "rFilterThreshB", &p->rFilterThreshB, 255);
 	}else if(color == 'G'){
-		cvCreateTrackbar("G >",winName, &gFilterThreshG_, 255, NULL );
-		cvCreateTrackbar("R <",winName, &gFilterThreshR_, 255, NULL );
-		cvCreateTrackbar("B <",winName, &gFilterThreshB_, 255, NULL );
+		createTrackbar("G >",winName, "gFilterThreshG", &p->gFilterThreshG, 255);
+		createTrackbar("R <",winName, "gFilterThreshR", &p->gFilterThreshR, 255);
+		createTrackbar("B <",winName, "gFilterThreshB", &p->gFilterThreshB, 255);
 	}else if(color == 'B'){
-		cvCreateTrackbar("B >",winName, &bFilterThreshB_, 255, NULL );
-		cvCreateTrackbar("R <",winName, &bFilterThreshR_, 255, NULL );
-		cvCreateTrackbar("G <",winName, &bFilterThreshG_, 255, NULL );
+		createTrackbar("B >",winName, "bFilterThreshB", &p->bFilterThreshB, 255);
+		createTrackbar("R <",winName, "bFilterThreshR", &p->bFilterThreshR, 255);
+		createTrackbar("G <",winName, "bFilterThreshG", &p->bFilterThreshG, 255);
 	}else{
-		cvCreateTrackbar("rel. R-part" ,winName, &sumPartR_, 100, NULL );
-		cvCreateTrackbar("rel. G-part" ,winName, &sumPartG_, 100, NULL );
-		cvCreateTrackbar("rel. B-part" ,winName, &sumPartB_, 100, NULL );
-		cvCreateTrackbar("abs. Off-set",winName, &sumAdd_,   255, NULL );
+		createTrackbar("rel. R-part" ,winName, "sumPartR", &p->sumPartR, 100);
+		createTrackbar("rel. G-part" ,winName, "sumPartG", &p->sumPartG, 100);
+		createTrackbar("rel. B-part" ,winName, "sumPartB", &p->sumPartB, 100);
+		createTrackbar("abs. Off-set",winName, "sumAdd",   &p->sumAdd,   255);
 	};
 };
 
-int  sizeRawImageData(TCPSocket *socket, int *s, int *w, int *h){
-	int rcvBufferSize = 124;
-	char echoBuffer[rcvBufferSize];
-	int bytesReceived = 0;
-	socket->send("GET_META_DATA",strlen("GET_META_DATA"));
-	if( (bytesReceived = socket->recv(echoBuffer,rcvBufferSize)) <= 0){
-		return (-1);
-	};
-
-	// interprete received data
-	char ch1,ch2,ch3,imageOrg;
-	int color, recvImageDataSize, nmbBytesTimeStamp;
-	int nmbTokens = sscanf(echoBuffer,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
-			w,h,&imageOrg,&color,&ch1,&ch2,&ch3,&recvImageDataSize,&nmbBytesTimeStamp);
-	if(nmbTokens != 9){
-		cerr << "Can't interprete image meta data, terminate process.\n";
-		return (-1);
-	};
-	*s = recvImageDataSize + nmbBytesTimeStamp;
-	return *s;
+void createTrackbar(const char *label, char *winName, const char *param, const int *setting, int max){
+	Trackbar &t = trackbars_[nmbTrackbars_++];
+	t.param = param;
+	filter_->params().lock();
+	t.value = *setting;
+	filter_->params().unlock();
+	t.applied = t.value;
+	cvCreateTrackbar(label, winName, &t.value, max, NULL);
 };
 
-bool updateImageData(TCPSocket *socket,unsigned char *storageImageData, int size){
-	int rcvBufferSize = size;
-	int idx = 0;
-	int bytesReceived = 0;
-	int totalBytesReceived = 0;
-	socket->send("GET_IMAGE_DATA",strlen("GET_IMAGE_DATA"));
-	do{
-		bytesReceived = socket->recv(&(storageImageData[idx]),rcvBufferSize);
-		totalBytesReceived += bytesReceived;
-		idx = totalBytesReceived;
-	}while(totalBytesReceived < size);
-	return true;
+void applyTrackbars(){
+	string assignments;
+	for(int k = 0; k < nmbTrackbars_; k++){
+		if(trackbars_[k].value != trackbars_[k].applied){
+			char text[64];
+			sprintf(text, "%s%s=%d", assignments.empty() ? "" : ",", trackbars_[k].param, trackbars_[k].value);
+			assignments += text;
+			trackbars_[k].applied = trackbars_[k].value;
+		};
+	};
+	if(!assignments.empty()){
+		filter_->params().set(assignments.c_str());
+	};
 };
 
-
 void printInfo(int argc, char *argv[]){
-		  if (argc != 4){     // Test for correct number of arguments
+		  if (argc < 4){     // Test for correct number of arguments
 		    cerr << "Usage: " << argv[0]
-		         << " <Port of this server> <Server of Data> <Port of Server of Data>" << endl;
+		         << " <Port of this server> <Server of Data> <Port of Server of Data> [options]" << endl;
+		    cerr << "\n"
+		         << "options:\n"
+		         << "--headless      no windows, the parameters are set by SET_PARAM\n"
+		         << "-displayFps <f> refresh rate cap of the windows (default 30)\n"
+		         << "-threads <n>    threads of the color filter (default: one per CPU)\n"
+		         << "-lut <0|1>      1: classify the pixels by lookup tables, rebuilt on\n"
+		         << "                every parameter change, instead of comparing them\n"
+		         << "                with the thresholds (default 0, same results)\n";
 		    exit(1);
 		  };
 
@@ -355,154 +333,23 @@ void printInfo(int argc, char *argv[]){
 		  THIS_SERVER_PORT_   = atoi(argv[1]);
 };
 
-
-
-void HandleTCPClient(TCPSocket *sock){
-  cout << "Handling central unit\n";
-  try {
-    cout << sock->getForeignAddress() << ":";
-  } catch (SocketException &e) {
-    cerr << "Unable to get foreign address" << endl;
-  }
-  try {
-    cout << sock->getForeignPort();
-  } catch (SocketException &e) {
-    cerr << "Unable to get foreign port" << endl;
-  }
-  cout << endl;
-  // Send received string and receive again until the end of transmission
-  int revBUFFER_SIZE = 100;
-
-  char revBuffer[revBUFFER_SIZE];
-  int recvMsgSize;
-
-  char echoMetaData[124];
-  char echoUnknownCommand[1024];
-
-  do{
-    try{
-    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
-    	if(recvMsgSize < 1) break;
-    }catch(...){
-    	break;
-    };
-
-
-    if(!(strncmp(GET_META_DATA,revBuffer,strlen(GET_META_DATA)))){
-    	// send meta data
-    	echoMetaData[0]='\0';
-    	sprintf(echoMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]%c",
-    			imageWidth_,imageHeight_,'W',CAMERA_COLOR_,'R','G','B',imageWidth_*imageHeight_,0,'\0');
-    	sock->send(echoMetaData,strlen(echoMetaData));
-    }else if(!(strncmp("GET_IMAGE_DATA",revBuffer,strlen(GET_IMAGE_DATA)))){
-    	// send image data
-		do{
-			if(!accessBlocked_){
-				sock->send(sumFilterData_,(imageWidth_*imageHeight_));
-				break;
-			}else{
-				cout << "access blocked continue request.\n";
-			};
-		}while(true);
-    }else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
-    	echoMetaData[0]='\0';
-    	sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
-    	sock->send(echoMetaData,strlen(echoMetaData));
-    }else{
-    	// send protocol
-    	echoUnknownCommand[0]='\0';
-    	sprintf(echoUnknownCommand,"%s please try:\n %s\n %s\n %s\n%c",UNKNOWN_COMMAND, GET_VERSION, GET_META_DATA, GET_IMAGE_DATA,'\0');
-		sock->send(echoUnknownCommand, strlen(echoUnknownCommand));
-    };
-  }while(true);
-
-  delete sock;
-
-};
-
-/*
-
-void HandleTCPClient(TCPSocket *sock){
-	  cout << "Handling central unit\n";
-	  try {
-	    cout << sock->getForeignAddress() << ":";
-	  } catch (SocketException &e) {
-	    cerr << "Unable to get foreign address" << endl;
-	  }
-	  try {
-	    cout << sock->getForeignPort();
-	  } catch (SocketException &e) {
-	    cerr << "Unable to get foreign port" << endl;
-	  }
-	  cout << endl;
-	  // Send received string and receive again until the end of transmission
-	  int revBUFFER_SIZE = 100;
-
-	  char revBuffer[revBUFFER_SIZE];
-	  int recvMsgSize;
-	  bool correct;
-
-	  do{
-	    try{
-	    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
-	    	if(recvMsgSize < 1) break;
-	    	revBuffer[recvMsgSize]='\0';
-	    }catch(...){
-	    	break;
-	    };
-
-	    printf(" msg: %s \n", revBuffer);
-
-	    if(!(strncmp("NUMBER_BYTES",revBuffer,strlen("NUMBER_BYTES")))){
-	    	correct=true;
-	    	// send size
-	    	char echo[64];
-	    	sprintf(echo,"%d=[w=%d,h=%d]",(imageWidth_*imageHeight_), imageWidth_,imageHeight_);
-	    	sock->send(echo,strlen(echo));
-	    }else if(!(strncmp("FILTER_DATA",revBuffer,strlen("FILTER_DATA")))){
-			do{
-				if(!accessBlocked_){
-					sock->send(sumFilterData_,(imageWidth_*imageHeight_));
-					break;
-				}else{
-					cout << "\t\t access blocked continue request.\n";
-				};
-			}while(true);
-	    }else{
-	    	correct=false;
-			sock->send("-1001", 20);
-	    };
-	  }while(true);
-
-	  delete sock;
-
-};
-*/
-
-void *runServer(void * genericPtr){
-	//cout << "+WAIT"; cout.flush();
-	while(bStop_){;};  // wait
-	pthread_yield();
-
-	//cout << "YES left \n"; cout.flush();
-	int i = 0;
-	try{
-		do{   // Run forever
-			HandleTCPClient(thisServer_->accept());       // Wait for a client to connect
-	    }while(!bStop_);
-	}catch (SocketException &e) {
-	    cerr << e.what() << endl;
+void readOptions(int argc, char *argv[]){
+	for(int i = 4; i < argc; i++){
+		if(!strcmp(argv[i], "--headless")){
+			HEADLESS_ = true;
+		}else if(i+1 == argc){
+			cerr << "No value of option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		}else if(!strcmp(argv[i], "-threads")){
+			FILTER_THREADS_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-lut")){
+			FILTER_LUT_ = atoi(argv[++i]);
+		}else if(!strcmp(argv[i], "-displayFps")){
+			DISPLAY_FPS_ = atof(argv[++i]);
+		}else{
+			cerr << "Unknown option " << argv[i] << ", terminate process.\n";
+			exit(1);
+		};
 	};
-	// Relenquish the CPU for another thread
-	pthread_yield();
-
-	delete thisServer_;
-	bStop_ = true;
-	return NULL;
 };
 
-
-
-
-
-
@@ -29,6 +29,15 @@
  * \brief Captures images from device -1 (usually the webcam on your laptop)
  * and provides these data as standard image datat server.
  *
+ * Instead of a camera the frames can be taken from a video file or a
+ * directory of images (see FrameSource), which are decoded ahead on
+ * a pool of threads.
+ *
+ * Frames are captured by a thread of their own and published in a
+ * LatestFrameSlot, client requests are answered with the latest frame
+ * and never wait for the camera.  Every frame carries its capture time
+ * (BTS=8, micro seconds since the epoch, little endian).
+ *
  */
 
 
@@ -37,6 +46,8 @@
 #include <iostream>
 #include <math.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
 
 
 //opencv
@@ -48,6 +59,18 @@ using namespace cv;
 #include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
 #include "../include/StdImgDataServerProtocol.H"  // For Socket, ServerSocket, and SocketException
 
+// pixel kernels
+#include "../include/ImgKernels.H"
+
+// frame rate
+#include "../include/FramePacer.H"
+
+// camera, video file or image directory
+#include "../include/FrameSource.H"
+
+// hand over from the capture thread
+#include "../include/LatestFrameSlot.H"
+
 
 
 
@@ -66,13 +89,31 @@ using namespace std;
 
 
 unsigned short SERVER_PORT_;
-int CAMERA_COLOR_;
+int CAMERA_COLOR_ = 1;
 int WINDOW_WIDTH_;
 int WINDOW_HEIGHT_;
 
 
-char *imageData_;
+// latest frame, image data followed by the capture time stamp
+LatestFrameSlot *slot_;
 int imageDataSize_;
+#define STATS_PERIOD 10           // seconds
+
+// source of the frames
+int   CAMERA_DEVICE_  = -1;
+char *VIDEO_FILE_     = NULL;
+char *IMAGE_DIR_      = NULL;
+int   DECODE_THREADS_ = 2;
+#define DECODE_POOL 8
+#define CAMERA_RETRY_MS 100       // wait after the camera delivered no frame
+#define CAMERA_RETRY_REPORT 100   // failed attempts between the reports
+
+IFrameSource *source_;
+
+// pacing, 0 captures frames as fast as the camera delivers them
+double     FPS_ = 0.0;
+FramePacer pacer_;
+#define PACING_REPORT_PERIOD 10   // seconds
 
 
 // Set this to true to stop the threads
@@ -80,9 +121,8 @@ int imageDataSize_;
 //   time, since another thread may write to it, and that it should not be
 //   included in any optimizations.
 volatile bool bStop_ = true;
-volatile bool accessBlocked_ = false;
-volatile bool requestForRead_ = false;
 void *runServer(void * genericPtr);
+void *runCapture(void * genericPtr);
 
 //server
 unsigned int RCVBUFSIZE;    // Size of receive buffer
@@ -95,6 +135,7 @@ unsigned char randomByte();
 
 // just some interactive text outputs
 void printInfo(int argc, char *argv[]);
+void readOptions(int argc, char *argv[]);
 void printCompleteLicense(int argc, char* args[]);
 void printLicense(int argc, char* args[]);
 
@@ -117,15 +158,24 @@ int main(int argc, char *argv[]){
 		cerr << "Can't read all parameter values, terminate programm.\n\n";
 		exit(0);
 	};
+	readOptions(argc, argv);
 
 
-	//CvCapture  *capture   = cvCaptureFromCAM(-1);  // internal webcam
-	CvCapture  *capture   = cvCaptureFromCAM(-1);
-	IplImage       *rgb   = cvQueryFrame( capture );
+	try{
+		if(VIDEO_FILE_ != NULL){
+			source_ = new VideoFileSource(VIDEO_FILE_, CAMERA_COLOR_, DECODE_POOL, true);
+		}else if(IMAGE_DIR_ != NULL){
+			source_ = new ImageDirectorySource(IMAGE_DIR_, CAMERA_COLOR_, DECODE_THREADS_, DECODE_POOL);
+		}else{
+			source_ = new CameraSource(CAMERA_DEVICE_, CAMERA_COLOR_);
+		};
+	}catch(string msg){
+		cerr << msg << endl;
+		exit(1);
+	};
 
-	WINDOW_HEIGHT_ = rgb->height;
-	WINDOW_WIDTH_  = rgb->width;
-	CAMERA_COLOR_  = 1;
+	WINDOW_HEIGHT_ = source_->height();
+	WINDOW_WIDTH_  = source_->width();
 
 
 	if((WINDOW_WIDTH_ < 1) || (WINDOW_HEIGHT_ < 1)){
@@ -138,44 +188,35 @@ int main(int argc, char *argv[]){
     initServer();
 
 
-    // organize the thread for dealing with request from clients
-    pthread_t serverID;
-    pthread_create(&serverID,NULL,runServer,NULL);
-    bStop_ = false; // start threads
-
     // allocate memory for the image data
   	if (CAMERA_COLOR_ == 0){
   		imageDataSize_ = WINDOW_WIDTH_ * WINDOW_HEIGHT_;
   	}else{
   		imageDataSize_ = WINDOW_WIDTH_ * WINDOW_HEIGHT_*3;
   	};
-  	imageData_ = new char[imageDataSize_+1];
+  	slot_ = new LatestFrameSlot(imageDataSize_ + TIME_STAMP_SIZE);
   	cout << "Number of bytes per image : " << imageDataSize_ << endl;
   	cout << "RES: " << WINDOW_WIDTH_ << " x " << WINDOW_HEIGHT_ << endl;
 
-    unsigned char *ptrD;
+
+    // organize the threads for capturing and for dealing with request from clients
+    pthread_t serverID, captureID;
+    pthread_create(&captureID,NULL,runCapture,NULL);
+    pthread_create(&serverID,NULL,runServer,NULL);
+    bStop_ = false; // start threads
 
 
-    // run the processes
+    // statistics of the capture thread
+    unsigned long published = 0, dropped = 0, overruns = 0;
     for(;;){
-    	if(!requestForRead_){
-    		accessBlocked_ = true;
-
-			rgb = cvQueryFrame( capture );
-    		if(rgb){
-    			for(int i = 0; i < WINDOW_HEIGHT_; i++){
-    				for(int j = 0; j < WINDOW_WIDTH_; j++){
-    					imageData_[3*((WINDOW_WIDTH_*i) + j) + 2] =
-    							((uchar *)(rgb->imageData + i*rgb->widthStep))[j*rgb->nChannels + 0]; // B
-    					imageData_[3*((WINDOW_WIDTH_*i) + j) + 1] =
-    							((uchar *)(rgb->imageData + i*rgb->widthStep))[j*rgb->nChannels + 1]; // G
-    					imageData_[3*((WINDOW_WIDTH_*i) + j) + 0] =
-    							((uchar *)(rgb->imageData + i*rgb->widthStep))[j*rgb->nChannels + 2]; // R
-    				};
-    			};
-    		};
-    		accessBlocked_ = false;
-    	};
+    	sleep(STATS_PERIOD);
+    	cout << "Frames captured " << slot_->nmbPublished() - published
+    	     << "  dropped " << slot_->nmbDropped() - dropped
+    	     << "  overruns " << slot_->nmbOverruns() - overruns
+    	     << " (last " << STATS_PERIOD << " s)" << endl;
+    	published = slot_->nmbPublished();
+    	dropped   = slot_->nmbDropped();
+    	overruns  = slot_->nmbOverruns();
     };
 
 
@@ -184,6 +225,70 @@ int main(int argc, char *argv[]){
 };
 
 
+/**
+ *
+ * \brief Captures frames into the latest frame slot. Frames which are
+ * replaced before a client requested them are counted as dropped.
+ *
+ * At the end of a file based source the thread ends, the clients get
+ * the last frame from then on.  If the camera delivers no frame, it is
+ * asked again every CAMERA_RETRY_MS.
+ *
+ */
+void *runCapture(void * genericPtr){
+	unsigned char *scratch = new unsigned char[imageDataSize_ + TIME_STAMP_SIZE];
+	long failures = 0;   // consecutive
+
+	pacer_ = FramePacer(FPS_);
+	pacer_.start();
+	for(;;){
+		// all buffers in use only if clients hold frames for too long,
+		// the frame is captured anyway to keep up with the camera
+		unsigned char *buffer = slot_->writeBuffer();
+		bool publish = (buffer != NULL);
+		if(!publish) buffer = scratch;
+
+		if(!source_->nextFrame(buffer)){
+			if(source_->endOfStream()){
+				cout << "End of the frames, serving the last one from now on." << endl;
+				break;
+			};
+			if((failures++ % CAMERA_RETRY_REPORT) == 0){
+				cerr << "No frame from the camera (" << failures << " failed attempts), trying again every "
+				     << CAMERA_RETRY_MS << " ms." << endl;
+			};
+			usleep(CAMERA_RETRY_MS * 1000);
+			continue;
+		};
+		if(failures > 0){
+			cout << "Frames from the camera again after " << failures << " failed attempts." << endl;
+			failures = 0;
+		};
+
+		if(publish){
+			struct timeval t;
+			gettimeofday(&t, NULL);
+			uint64_t timeStamp = ((uint64_t) t.tv_sec) * 1000000 + t.tv_usec;
+			for(int k = 0; k < TIME_STAMP_SIZE; k++){
+				buffer[imageDataSize_ + k] = (unsigned char) (timeStamp >> (8*k));
+			};
+			slot_->publish(timeStamp);
+		};
+
+		if(pacer_.enabled()){
+			pacer_.wait();
+			if(pacer_.nmbFrames() >= FPS_ * PACING_REPORT_PERIOD){
+				cout << "Pacing " << FPS_ << " fps: " << pacer_.report() << endl;
+				pacer_.reset();
+			};
+		};
+	};
+
+	delete [] scratch;
+	return NULL;
+};
+
+
 
 void initServer(){
 	// communication
@@ -231,20 +336,21 @@ void HandleTCPClient(TCPSocket *sock){
     	// send meta data
     	echoMetaData[0]='\0';
     	sprintf(echoMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]%c",
-    			WINDOW_WIDTH_,WINDOW_HEIGHT_,'W',CAMERA_COLOR_,'R','G','B',imageDataSize_,0,'\0');
+    			WINDOW_WIDTH_,WINDOW_HEIGHT_,'W',CAMERA_COLOR_,'R','G','B',imageDataSize_,TIME_STAMP_SIZE,'\0');
     	sock->send(echoMetaData,strlen(echoMetaData));
     }else if(!(strncmp("GET_IMAGE_DATA",revBuffer,strlen(GET_IMAGE_DATA)))){
-    	// send image data
-		do{
-			if(!accessBlocked_){
-				sock->send(imageData_, imageDataSize_);
-				requestForRead_ = false;
-				break;
-			}else{
-				requestForRead_ = true;
-				cout << "access blocked continue request.\n";
-			};
-		}while(true);
+    	// send latest image data and their time stamp
+    	LatestFrame frame;
+    	while(!slot_->acquire(&frame)){
+    		usleep(1000);    // no frame captured yet
+    	};
+    	try{
+    		sock->send(frame.data, imageDataSize_ + TIME_STAMP_SIZE);
+    	}catch(SocketException &e){
+    		slot_->release(&frame);
+    		throw;
+    	};
+    	slot_->release(&frame);
     }else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
     	echoMetaData[0]='\0';
     	sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
@@ -292,19 +398,49 @@ unsigned char randomByte(){
 
 
 void printInfo(int argc, char *argv[]){
-		  if (argc == 2){
+		  if ((argc == 2) || ((argc >= 4) && ((argc % 2) == 0))){
 			  return;
 		  }else if (argc == 3){
 			  printCompleteLicense(argc,argv);
 		  }else{     // Test for correct number of arguments
 		    cerr << "Usage of " << argv[0] << " : \n\n"
-		         << argv[0] << " <port> " << endl;
+		         << argv[0] << " <port> [options]" << endl;
 		    cerr << "\n"
-		    	 << "<port>          port number of this server\n";
+		    	 << "<port>          port number of this server\n"
+		    	 << "\noptions:\n"
+		    	 << "-color <c>      color (1, default) or grey (0) image data\n"
+		    	 << "-camera <n>     capture from camera device n (default -1)\n"
+		    	 << "-video <file>   frames of a video file, repeated endlessly\n"
+		    	 << "-images <dir>   images of a directory in alphabetical order,\n"
+		    	 << "                repeated endlessly\n"
+		    	 << "-threads <n>    threads decoding the images ahead (default 2)\n"
+		    	 << "-fps <f>        capture f frames per second (default: as fast\n"
+		    	 << "                as the camera delivers), prints the pacing jitter\n";
 		    printLicense(argc,argv);
 		  };
 };
 
+void readOptions(int argc, char *argv[]){
+	for(int i = 2; i+1 < argc; i += 2){
+		if(!strcmp(argv[i], "-fps")){
+			FPS_ = atof(argv[i+1]);
+		}else if(!strcmp(argv[i], "-color")){
+			CAMERA_COLOR_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-camera")){
+			CAMERA_DEVICE_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-video")){
+			VIDEO_FILE_ = argv[i+1];
+		}else if(!strcmp(argv[i], "-images")){
+			IMAGE_DIR_ = argv[i+1];
+		}else if(!strcmp(argv[i], "-threads")){
+			DECODE_THREADS_ = atoi(argv[i+1]);
+		}else{
+			cerr << "Unknown option " << argv[i] << ", terminate process.\n";
+			exit(0);
+		};
+	};
+};
+
 void printLicense(int argc, char* args[]){
 	char c;
 	cout << endl;
@@ -0,0 +1,310 @@
+/*
+    This program is an implementation of a standard
+    image data server which replays a recording.
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ *
+ * \file stdImgDataServerReplay.cpp
+ *
+ * \brief Serves the frames of a recording (see stdImgDataRecorder)
+ * with the meta data of the recorded server.
+ *
+ * The recording is memory mapped, frames are sent directly from the
+ * page cache.  With speed s > 0 a request is answered with the frame
+ * which was recorded at s times the time passed since the start of the
+ * server; with speed 0 every request gets the next frame, which serves
+ * the recording as fast as the clients request it.  The replay starts
+ * again at the beginning when the end of the recording is reached.
+ *
+ */
+
+
+#include <iostream>           // For cerr and cout
+#include <cstdlib>            // For atoi()
+#include <cstring>            // For strncmp()
+#include <iostream>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>            // For sched_yield()
+#include <time.h>
+
+// communication
+#include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
+#include "../include/StdImgDataServerProtocol.H"  // For Socket, ServerSocket, and SocketException
+
+// recordings
+#include "../include/FrameRecording.H"
+
+
+
+// On Linux, you must compile with the -D_REENTRANT option.  This tells
+// the C/C++ libraries that the functions must be thread-safe
+#ifndef _REENTRANT
+#error ACK! You need to compile with _REENTRANT defined since this uses threads
+#endif
+
+
+
+using namespace std;
+
+
+
+
+unsigned short SERVER_PORT_;
+char          *RECORDING_FILE_;
+double         SPEED_ = 1.0;
+
+FrameRecording recording_;
+uint64_t       duration_;      // of the recording in micro seconds
+uint64_t       startTime_;     // of the replay in micro seconds
+int            nextFrame_ = 0; // speed 0 only
+
+
+// Set this to true to stop the threads
+// - The volatile keyword tells the compiler that this value may change at any
+//   time, since another thread may write to it, and that it should not be
+//   included in any optimizations.
+volatile bool bStop_ = true;
+void *runServer(void * genericPtr);
+
+//server
+TCPServerSocket *server_;
+void HandleTCPClient(TCPSocket *sock);
+void initServer();
+
+// replay
+uint64_t monotonicUs();
+int currentFrame();
+
+// just some interactive text outputs
+void printInfo(int argc, char *argv[]);
+void printCompleteLicense(int argc, char* args[]);
+void printLicense(int argc, char* args[]);
+
+
+
+/**
+ *
+ * @param argc number of command line parameter
+ * @param *argv[] list of parameters
+ */
+int main(int argc, char *argv[]){
+
+	// check command line and read parameters
+	printInfo(argc, argv);
+	SERVER_PORT_   = (unsigned short) atoi(argv[1]);
+	RECORDING_FILE_ = argv[2];
+	if(argc > 3){
+		char *end;
+		SPEED_ = strtod(argv[3], &end);
+		if((end == argv[3]) || (*end != '\0')){
+			cerr << "Invalid replay speed " << argv[3] << ", terminate process.\n";
+			exit(1);
+		};
+	};
+	if(SPEED_ < 0.0){
+		cerr << "Negative replay speed, terminate process.\n";
+		exit(1);
+	};
+
+	try{
+		recording_.open(RECORDING_FILE_);
+	}catch(string msg){
+		cerr << msg << endl;
+		exit(1);
+	};
+	duration_ = recording_.timeStamp(recording_.nmbFrames()-1) - recording_.timeStamp(0);
+
+	cout << "Recording of   : " << recording_.version() << endl;
+	cout << "META_DATA      : " << recording_.metaData() << endl;
+	cout << "Number of frames: " << recording_.nmbFrames()
+	     << " (" << ((double) duration_) / 1e6 << " s)" << endl;
+
+  	// init communication
+    initServer();
+
+    // organize the thread for dealing with request from clients
+    pthread_t serverID;
+    startTime_ = monotonicUs();
+    pthread_create(&serverID,NULL,runServer,NULL);
+    bStop_ = false; // start threads
+
+    pthread_join(serverID, NULL);
+    recording_.close();
+    exit(0);
+};
+
+
+uint64_t monotonicUs(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ((uint64_t) t.tv_sec) * 1000000 + t.tv_nsec / 1000;
+};
+
+
+int currentFrame(){
+	if(SPEED_ == 0.0){
+		int i = nextFrame_;
+		nextFrame_ = (nextFrame_ + 1) % recording_.nmbFrames();
+		return i;
+	};
+
+	uint64_t relTime = (uint64_t) (((double) (monotonicUs() - startTime_)) * SPEED_);
+	if(duration_ > 0){
+		relTime = relTime % (duration_ + 1);
+	};
+	return recording_.frameAt(relTime);
+};
+
+
+void initServer(){
+	// communication
+	try {
+		server_ = new TCPServerSocket(SERVER_PORT_); // Server Socket object
+	}catch (SocketException &e) {
+		cerr << e.what() << endl;
+		exit(1);
+	};
+};
+
+
+void HandleTCPClient(TCPSocket *sock){
+  cout << "Handling central unit\n";
+  try {
+    cout << sock->getForeignAddress() << ":";
+  } catch (SocketException &e) {
+    cerr << "Unable to get foreign address" << endl;
+  }
+  try {
+    cout << sock->getForeignPort();
+  } catch (SocketException &e) {
+    cerr << "Unable to get foreign port" << endl;
+  }
+  cout << endl;
+  // Send received string and receive again until the end of transmission
+  int revBUFFER_SIZE = 100;
+
+  char revBuffer[revBUFFER_SIZE];
+  int recvMsgSize;
+
+  char echoMetaData[124];
+  char echoUnknownCommand[1024];
+
+  do{
+    try{
+    	recvMsgSize = sock->recv(revBuffer, revBUFFER_SIZE);
+    	if(recvMsgSize < 1) break;
+    }catch(...){
+    	break;
+    };
+
+    try{
+      if(!(strncmp(GET_META_DATA,revBuffer,strlen(GET_META_DATA)))){
+    	// send meta data of the recorded server
+    	sock->send(recording_.metaData().c_str(), recording_.metaData().length());
+      }else if(!(strncmp(GET_IMAGE_DATA,revBuffer,strlen(GET_IMAGE_DATA)))){
+    	// send image data directly out of the mapped recording
+    	sock->send(recording_.frame(currentFrame()), recording_.frameSize());
+      }else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
+    	echoMetaData[0]='\0';
+    	sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
+    	sock->send(echoMetaData,strlen(echoMetaData));
+      }else{
+    	// send protocol
+    	echoUnknownCommand[0]='\0';
+    	sprintf(echoUnknownCommand,"%s please try:\n %s\n %s\n %s\n%c",UNKNOWN_COMMAND, GET_VERSION, GET_META_DATA, GET_IMAGE_DATA,'\0');
+		sock->send(echoUnknownCommand, strlen(echoUnknownCommand));
+      };
+    }catch(SocketException &e){
+    	cerr << e.what() << endl;
+    	break;
+    };
+  }while(true);
+
+  delete sock;
+
+};
+
+
+void *runServer(void * genericPtr){
+
+	while(bStop_){;};  // wait
+	sched_yield();
+
+	try{
+		do{   // Run forever
+			HandleTCPClient(server_->accept());       // Wait for a client to connect
+	    }while(!bStop_);
+	}catch (SocketException &e) {
+	    cerr << e.what() << endl;
+	};
+	// Relenquish the CPU for another thread
+	sched_yield();
+
+	delete server_;
+	bStop_ = true;
+	return NULL;
+};
+
+
+void printInfo(int argc, char *argv[]){
+		  if ((argc == 3) || (argc == 4)){
+			  return;
+		  }else if (argc == 2){
+			  printCompleteLicense(argc,argv);
+		  }else{     // Test for correct number of arguments
+		    cerr << "Usage of " << argv[0] << " : \n\n"
+		         << argv[0] << " <port> <recording> [<speed>]" << endl;
+		    cerr << "\n"
+		    	 << "<port>          port number of this server\n"
+		    	 << "<recording>     recording made by stdImgDataRecorder\n"
+		    	 << "<speed>         1 original rate (default), 2 twice as fast, ...\n"
+		    	 << "                0 next frame on every request\n";
+		    printLicense(argc,argv);
+		    exit(1);
+		  };
+};
+
+void printLicense(int argc, char* args[]){
+	cout << endl;
+    cout << "" << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+    cout << "" << "This is free software, and you are welcome to redistribute it\n";
+    cout << "" << "under certain conditions; type: \n";
+    cout << "" << "'" << args[0] << " license' for details.\n\n";
+};
+
+
+
+void printCompleteLicense(int argc, char* args[]){
+	cout << endl;
+	cout << "\t"<< "This program is free software: you can redistribute it and/or modify \n";
+	cout << "\t"<< "it under the terms of the GNU General Public License as published by \n";
+	cout << "\t"<< "the Free Software Foundation, either version 3 of the License, or \n";
+	cout << "\t"<< "(at your option) any later version. \n\n";
+
+	cout << "\t"<< "This program is distributed in the hope that it will be useful, \n";
+	cout << "\t"<< "but WITHOUT ANY WARRANTY; without even the implied warranty of \n";
+	cout << "\t"<< "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the \n";
+	cout << "\t"<< "GNU General Public License for more details. \n\n";
+
+	cout << "\t"<< "You might have received a copy of the GNU General Public License \n";
+	cout << "\t"<< "along with this program.  If not, see <http://www.gnu.org/licenses/>. \n\n";
+
+	exit(0);
+};
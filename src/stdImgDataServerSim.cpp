@@ -28,6 +28,12 @@
  * \brief Generates random grey or color image data
  * of the given resolution.
  *
+ * With the scene "discs" the image data show coloured discs moving
+ * over a dark background (see SyntheticScene).  The true disc centres
+ * of every frame are returned by the command GET_GROUND_TRUTH for the
+ * frame last sent on the connection, and with -truth written into a
+ * file, one line per frame sent: "<seq> N=<n>,<x>:<y>:<radius>,...".
+ *
  */
 
 
@@ -36,11 +42,23 @@
 #include <iostream>
 #include <math.h>
 #include <pthread.h>
+#include <time.h>
+#include <stdio.h>
 
 // communication
 #include "../include/Socket.H"  // For Socket, ServerSocket, and SocketException
 #include "../include/StdImgDataServerProtocol.H"  // For Socket, ServerSocket, and SocketException
 
+// pixel kernels
+#include "../include/ImgKernels.H"
+#include "../include/SyntheticScene.H"
+
+// frame rate
+#include "../include/FramePacer.H"
+
+// hand over of the generated frames
+#include "../include/LatestFrameSlot.H"
+
 
 
 
@@ -64,17 +82,48 @@ int WINDOW_WIDTH_;
 int WINDOW_HEIGHT_;
 
 
-char *imageData_;
 int imageDataSize_;
 
+// frame bank, BANK_SIZE_ frames generated at start up
+int    BANK_SIZE_ = 0;
+char **bank_;
+
+ImgKernels::RandomState random_;
+
+// scene
+char  *SCENE_       = (char *) "noise";
+int    NMB_DISCS_   = 3;
+int    DISC_RADIUS_ = 20;
+double SPEED_       = 2.0;
+int    NOISE_       = 0;
+char  *TRUTH_FILE_  = NULL;
+
+SyntheticScene *scene_ = NULL;
+FILE           *truthFile_ = NULL;
+
+// sequence number of the frame last generated or taken from the bank,
+// bank frames keep their own ground truth
+#define TRUTH_SIZE 2048
+volatile unsigned long frameSeq_ = 0;
+char **bankTruth_;
+
+// generated frames served to the clients (one at a time), the ground
+// truth behind the image data and the sequence number as time stamp,
+// so a frame is always sent with its own ground truth
+#define SLOT_READERS 1
+LatestFrameSlot *slot_ = NULL;
+
+// pacing, 0 generates frames as fast as possible
+double     FPS_ = 0.0;
+FramePacer pacer_;
+#define PACING_REPORT_PERIOD 10   // seconds
+
 
 // Set this to true to stop the threads
 // - The volatile keyword tells the compiler that this value may change at any
 //   time, since another thread may write to it, and that it should not be
 //   included in any optimizations.
 volatile bool bStop_ = true;
-volatile bool accessBlocked_ = false;
-volatile bool requestForRead_ = false;
 void *runServer(void * genericPtr);
 
 //server
@@ -83,11 +132,12 @@ TCPServerSocket *server_;
 void HandleTCPClient(TCPSocket *sock);
 void initServer();
 
-// random value generation
-unsigned char randomByte();
+// image data
+void generateFrame(char *imageData, char *truth);
 
 // just some interactive text outputs
 void printInfo(int argc, char *argv[]);
+void readOptions(int argc, char *argv[]);
 void printCompleteLicense(int argc, char* args[]);
 void printLicense(int argc, char* args[]);
 
@@ -111,6 +161,7 @@ int main(int argc, char *argv[]){
 		cerr << "Can't read all parameter values, terminate programm.\n\n";
 		exit(0);
 	};
+	readOptions(argc, argv);
 
 	if((WINDOW_WIDTH_ < 1) || (WINDOW_HEIGHT_ < 1)){
 		cerr << "Image dimebsions zero of negative, terminate process.\n";
@@ -121,34 +172,89 @@ int main(int argc, char *argv[]){
   	// init communication
     initServer();
 
-
-    // organize the thread for dealing with request from clients
-    pthread_t serverID;
-    pthread_create(&serverID,NULL,runServer,NULL);
-    bStop_ = false; // start threads
-
     // allocate memory for the image data
   	if (CAMERA_COLOR_ == 0){
   		imageDataSize_ = WINDOW_WIDTH_ * WINDOW_HEIGHT_;
   	}else{
   		imageDataSize_ = WINDOW_WIDTH_ * WINDOW_HEIGHT_*3;
   	};
-  	imageData_ = new char[imageDataSize_+1];
   	cout << "Number of bytes per image : " << imageDataSize_ << endl;
   	cout << "RES: " << WINDOW_WIDTH_ << " x " << WINDOW_HEIGHT_ << endl;
 
-    unsigned char *ptrD;
+  	ImgKernels::randomSeed(&random_, (unsigned long long) time(NULL));
+  	if(!strcmp(SCENE_, "discs")){
+  		scene_ = new SyntheticScene(WINDOW_WIDTH_, WINDOW_HEIGHT_, CAMERA_COLOR_,
+  				NMB_DISCS_, DISC_RADIUS_, SPEED_, NOISE_, (unsigned long long) time(NULL));
+  		cout << "Scene: " << NMB_DISCS_ << " discs, radius " << DISC_RADIUS_
+  		     << ", speed " << SPEED_ << ", noise " << NOISE_ << endl;
+  	}else if(strcmp(SCENE_, "noise")){
+  		cerr << "Unknown scene " << SCENE_ << ", terminate process.\n";
+  		exit(0);
+  	};
+  	if(TRUTH_FILE_ != NULL){
+  		truthFile_ = fopen(TRUTH_FILE_, "w");
+  		if(truthFile_ == NULL){
+  			cerr << "Can't open " << TRUTH_FILE_ << ", terminate process.\n";
+  			exit(1);
+  		};
+  	};
 
+  	if(BANK_SIZE_ > 0){
+  		bank_      = new char*[BANK_SIZE_];
+  		bankTruth_ = new char*[BANK_SIZE_];
+  		for(int k = 0; k < BANK_SIZE_; k++){
+  			bank_[k]      = new char[imageDataSize_+1];
+  			bankTruth_[k] = new char[TRUTH_SIZE];
+  			generateFrame(bank_[k], bankTruth_[k]);
+  		};
+  		cout << "Frame bank of " << BANK_SIZE_ << " frames generated\n";
+  	}else{
+  		slot_ = new LatestFrameSlot(imageDataSize_ + TRUTH_SIZE, SLOT_READERS);
+  		unsigned char *frame = slot_->writeBuffer();
+  		generateFrame((char *) frame, (char *) frame + imageDataSize_);
+  		slot_->publish(frameSeq_);
+  	};
+
+
+    // organize the thread for dealing with request from clients
+    pthread_t serverID;
+    pthread_create(&serverID,NULL,runServer,NULL);
+    bStop_ = false; // start threads
+
+
+    if((BANK_SIZE_ > 0) && !(FPS_ > 0.0)){
+    	// unpaced, every request takes the next frame of the bank
+    	// (HandleTCPClient); nothing to do until the server ends
+    	pthread_join(serverID, NULL);
+    	exit(1);
+    };
 
     // run the processes
+    pacer_ = FramePacer(FPS_);
+    pacer_.start();
     for(;;){
-    	if(!requestForRead_){
-    		accessBlocked_ = true;
-    		for(int i = 0; i < imageDataSize_;i++){
-    			// write image data, while server handler can't read them
-    			imageData_[i] = randomByte();
+    	if(BANK_SIZE_ > 0){
+    		// the frames of the bank are never written again, the server
+    		// handler can read any of them at any time; it takes the frame
+    		// from the sequence number
+    		frameSeq_++;
+    	}else{
+    		// never a buffer being sent; none free if the handler holds
+    		// them all, the frame is skipped then
+    		unsigned char *frame = slot_->writeBuffer();
+    		if(frame != NULL){
+    			generateFrame((char *) frame, (char *) frame + imageDataSize_);
+    			frameSeq_++;
+    			slot_->publish(frameSeq_);
+    		};
+    	};
+
+    	if(pacer_.enabled()){
+    		pacer_.wait();
+    		if(pacer_.nmbFrames() >= FPS_ * PACING_REPORT_PERIOD){
+    			cout << "Pacing " << FPS_ << " fps: " << pacer_.report() << endl;
+    			pacer_.reset();
     		};
-    		accessBlocked_ = false;
     	};
     };
 
@@ -159,6 +265,18 @@ int main(int argc, char *argv[]){
 
 
 
+void generateFrame(char *imageData, char *truth){
+	if(scene_ != NULL){
+		scene_->render(imageData);
+		scene_->groundTruth(truth, TRUTH_SIZE);
+		scene_->step();
+	}else{
+		ImgKernels::randomFillFast(&random_, imageData, imageDataSize_);
+		sprintf(truth, "N=0");
+	};
+};
+
+
 void initServer(){
 	// communication
 	try {
@@ -191,6 +309,12 @@ void HandleTCPClient(TCPSocket *sock){
 
   char echoMetaData[124];
   char echoUnknownCommand[1024];
+  char echoTruth[TRUTH_SIZE + 32];
+
+  // ground truth of the frame last sent on this connection
+  unsigned long sentSeq = 0;
+  char sentTruth[TRUTH_SIZE];
+  sprintf(sentTruth, "N=0");
 
   do{
     try{
@@ -209,16 +333,36 @@ void HandleTCPClient(TCPSocket *sock){
     	sock->send(echoMetaData,strlen(echoMetaData));
     }else if(!(strncmp("GET_IMAGE_DATA",revBuffer,strlen(GET_IMAGE_DATA)))){
     	// send image data
-		do{
-			if(!accessBlocked_){
-				sock->send(imageData_, imageDataSize_);
-				requestForRead_ = false;
-				break;
-			}else{
-				requestForRead_ = true;
-				cout << "access blocked continue request.\n";
+		if(BANK_SIZE_ > 0){
+			if(!(FPS_ > 0.0)){
+				frameSeq_++;    // one client at a time, no other writer
+			};
+			sentSeq = frameSeq_;
+			strcpy(sentTruth, bankTruth_[sentSeq % BANK_SIZE_]);
+			sock->send(bank_[sentSeq % BANK_SIZE_], imageDataSize_);
+		}else{
+			// frame and ground truth of the latest frame, held while sent
+			LatestFrame frame;
+			slot_->acquire(&frame);
+			sentSeq = (unsigned long) frame.timeStamp;
+			strcpy(sentTruth, (const char *) frame.data + imageDataSize_);
+			try{
+				sock->send(frame.data, imageDataSize_);
+			}catch(SocketException &e){
+				slot_->release(&frame);
+				throw;
 			};
-		}while(true);
+			slot_->release(&frame);
+		};
+		if(truthFile_ != NULL){
+			fprintf(truthFile_, "%lu %s\n", sentSeq, sentTruth);
+			fflush(truthFile_);
+		};
+    }else if(!(strncmp(GET_GROUND_TRUTH,revBuffer,strlen(GET_GROUND_TRUTH)))){
+    	// send ground truth of the frame last sent
+    	echoTruth[0]='\0';
+    	sprintf(echoTruth,"[SEQ=%lu,%s]%c",sentSeq,sentTruth,'\0');
+    	sock->send(echoTruth,strlen(echoTruth));
     }else if(!(strncmp(GET_VERSION,revBuffer,strlen(GET_VERSION)))){
     	echoMetaData[0]='\0';
     	sprintf(echoMetaData,"%s%c",CURRENT_VERSION,'\0');
@@ -226,7 +370,7 @@ void HandleTCPClient(TCPSocket *sock){
     }else{
     	// send protocol
     	echoUnknownCommand[0]='\0';
-    	sprintf(echoUnknownCommand,"%s please try:\n %s\n %s\n %s\n%c",UNKNOWN_COMMAND, GET_VERSION, GET_META_DATA, GET_IMAGE_DATA,'\0');
+    	sprintf(echoUnknownCommand,"%s please try:\n %s\n %s\n %s\n %s\n%c",UNKNOWN_COMMAND, GET_VERSION, GET_META_DATA, GET_IMAGE_DATA, GET_GROUND_TRUTH,'\0');
 		sock->send(echoUnknownCommand, strlen(echoUnknownCommand));
     };
   }while(true);
@@ -259,29 +403,60 @@ void *runServer(void * genericPtr){
 	return NULL;
 };
 
-unsigned char randomByte(){
-	unsigned int i = ((unsigned int) 255*((float)rand()) / ((float) RAND_MAX));
-	return ((unsigned char) i);
-};
-
-
 void printInfo(int argc, char *argv[]){
-		  if (argc == 5){
+		  if ((argc >= 5) && ((argc % 2) == 1)){
 			  return;
 		  }else if (argc == 3){
 			  printCompleteLicense(argc,argv);
 		  }else{     // Test for correct number of arguments
 		    cerr << "Usage of " << argv[0] << " : \n\n"
-		         << argv[0] << " <port> <color> <camWidth> <camHeight> " << endl;
+		         << argv[0] << " <port> <color> <camWidth> <camHeight> [options]" << endl;
 		    cerr << "\n"
 		    	 << "<port>          port number of this server\n"
 		    	 << "<color>         color (1) or grey (0) image data\n"
 		    	 << "<camWidth>      image width\n"
-		    	 << "<camHeight>     image height\n";
+		    	 << "<camHeight>     image height\n"
+		    	 << "\noptions:\n"
+		    	 << "-bank <K>       generate K frames at start up and rotate through\n"
+		    	 << "                them instead of generating every frame (without\n"
+		    	 << "                -fps the next one on every request)\n"
+		    	 << "-scene <name>   noise (default) or discs\n"
+		    	 << "-discs <N>      number of discs (default 3)\n"
+		    	 << "-radius <r>     disc radius in pixels (default 20)\n"
+		    	 << "-speed <s>      disc speed in pixels per frame (default 2)\n"
+		    	 << "-noise <a>      noise amplitude added to the scene (default 0)\n"
+		    	 << "-truth <file>   write the ground truth of every frame sent\n"
+		    	 << "-fps <f>        generate f frames per second (default: as fast\n"
+		    	 << "                as possible), prints the pacing jitter\n";
 		    printLicense(argc,argv);
 		  };
 };
 
+void readOptions(int argc, char *argv[]){
+	for(int i = 5; i+1 < argc; i += 2){
+		if(!strcmp(argv[i], "-bank")){
+			BANK_SIZE_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-scene")){
+			SCENE_ = argv[i+1];
+		}else if(!strcmp(argv[i], "-discs")){
+			NMB_DISCS_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-radius")){
+			DISC_RADIUS_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-speed")){
+			SPEED_ = atof(argv[i+1]);
+		}else if(!strcmp(argv[i], "-noise")){
+			NOISE_ = atoi(argv[i+1]);
+		}else if(!strcmp(argv[i], "-truth")){
+			TRUTH_FILE_ = argv[i+1];
+		}else if(!strcmp(argv[i], "-fps")){
+			FPS_ = atof(argv[i+1]);
+		}else{
+			cerr << "Unknown option " << argv[i] << ", terminate process.\n";
+			exit(0);
+		};
+	};
+};
+
 void printLicense(int argc, char* args[]){
 	char c;
 	cout << endl;
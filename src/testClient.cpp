@@ -26,37 +26,40 @@
 #include <cstdlib>            // For atoi()
 
 #include "../include/StdImgDataServerProtocol.H"
+#include "../include/ImgKernels.H"
+#include "../include/DisplayThread.H"
+#include "../include/StdImgClient.H"
 
 //opencv
 #include <opencv2/opencv.hpp>
 
 using namespace cv;
 
-TCPSocket     *dataSource_ = NULL;
+StdImgClient  *dataSource_ = NULL;
 unsigned short SOURCE_SERVER_PORT_;
 char          *SOURCE_SERVER_ADR_;
 
 char *recvImageData_;
-int recvImageDataSize_;
 int imageWidth_;
 int imageHeight_;
 int color_;
-char imageOrg_;
-char ch1_;
-char ch2_;
-char ch3_;
-int nmbBytesTimeStamp_;
 
 // view and filters
 char* winName_;
 IplImage *openCvImage_;
 
+// the window is updated by a thread of its own, at most DISPLAY_FPS_
+// times per second, the frames are received straight into its buffers
+double DISPLAY_FPS_ = 30.0;
+DisplayThread *display_ = NULL;
+
 
 void printInfo(int argc, char *argv[]);
 
 
-bool updateImageData(TCPSocket *socket, char *storageImageData, int size);
 void updateImageView(IplImage *openCvImageRaw, char *imgD, int color);
+void openDisplay(void *arg);
+void showDisplay(const unsigned char *frame, void *arg);
 
 // just some interactive text outputs
 void printInfo(int argc, char *argv[]);
@@ -87,62 +90,64 @@ int main(int argc, char *argv[]){
 
 	// client for image data
 	try{
-		dataSource_ = new TCPSocket(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
-	}catch(...){
-		cout << "No server for image data.\n" << SOURCE_SERVER_ADR_ << endl << endl;
+		dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
+	}catch(string msg){
+		cerr << msg << endl << endl;
 		exit(1);
 	};
+	cout << "Server version: " << dataSource_->version() << endl;
+	cout << "META_DATA received: " << dataSource_->metaDataText() << endl;
 
+	imageWidth_  = dataSource_->metaData().width;
+	imageHeight_ = dataSource_->metaData().height;
+	color_       = dataSource_->metaData().color;
+	// memory for the image data with might include some bytes at the end
+	// containing the time stamp
+	recvImageData_ = new char[dataSource_->frameSize()];
 
-	// get meta data
-	int sizeEchoBufferMetaData = 64;
-	char echoBufferMetaData[sizeEchoBufferMetaData];
-	int bytesReceived = 0;
 
-	try{
-		dataSource_->send(GET_VERSION,strlen(GET_VERSION));
-	}catch(...){
-		cerr << "Error while sending: " << GET_VERSION << endl;
-		exit(0);
-	};
+	//view
+	display_ = new DisplayThread(dataSource_->frameSize(), DISPLAY_FPS_, openDisplay, showDisplay, NULL);
+	display_->start();
 
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		cerr << "Can't get Standard Image Data Server Version, terminate process.\n";
-		exit(0);
-	};
-	echoBufferMetaData[bytesReceived]='\0';
-	cout << "Server version: " << echoBufferMetaData << endl;
+	char *frame;
+	do{
+		// into a buffer of the display if there is a free one, the
+		// frame is just not shown otherwise
+		frame = (char *) display_->writeBuffer();
+		if(frame == NULL){
+			frame = recvImageData_;
+		};
+		if(!dataSource_->receive((unsigned char *) frame)){
+			break;
+		};
 
-	echoBufferMetaData[0]='\0';
-	try{
-		dataSource_->send(GET_META_DATA,strlen(GET_META_DATA));
-	}catch(...){
-		cerr << "Error while sending: " << GET_META_DATA << endl;
-		exit(0);
-	};
+		// now all the image data are received and can be accessed via the
+		// pointer frame; this array contains recvImageDataSize tokens
+		// of type "unsigned char" (which is a byte) and nmbBytesTimeStamp
+		// bytes at the end which represent the time stamp;
+		// if nmbBytesTimeStamp is zero then we have image data only, no
+		// time stamp is provided by the server;
 
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		cerr << "Can't get image meta data, terminate process.\n";
-		exit(0);
-	};
-	echoBufferMetaData[bytesReceived]='\0';
-	cout << "META_DATA received: " << echoBufferMetaData << endl;
 
 
+		// the display thread transfers/transforms the image data into an openCv
+		// image structure and shows them in a window
+		if(frame != recvImageData_){
+			display_->publish();
+		};
+	}while(true);
 
-	// interprete received data
-	int nmbTokens = sscanf(echoBufferMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
-			&imageWidth_,&imageHeight_,&imageOrg_,&color_,&ch1_,&ch2_,&ch3_,&recvImageDataSize_,&nmbBytesTimeStamp_);
-	if(nmbTokens != 9){
-		cerr << "Can't interpret image meta data, terminate process.\n";
-		exit(0);
-	};
-	// allocate memory for the image data with might include some bytes
-	// at the end containing the time stamp
-	recvImageData_ = new char[recvImageDataSize_ + nmbBytesTimeStamp_];
 
+	delete display_;
+	delete dataSource_;
+	delete [] recvImageData_;
+	exit(0);
+};
 
-	//view
+
+
+void openDisplay(void *arg){
 	winName_ = new char[124];
 	if(color_ != 1){
 		sprintf(winName_,"Received %s Image ( %d x %d )","grey", imageWidth_, imageHeight_);
@@ -153,80 +158,26 @@ int main(int argc, char *argv[]){
 	};
 
 	cvNamedWindow(winName_, 0);
+};
 
-	while(updateImageData(dataSource_,recvImageData_,(recvImageDataSize_ + nmbBytesTimeStamp_))){
-
-		// now all the image data are received and can be accessed via the
-		// pointer recvImageData_; this array contains recvImageDataSize tokens
-		// of type "unsigned char" (which is a byte) and nmbBytesTimeStamp
-		// bytes at the end which represent the time stamp;
-		// if nmbBytesTimeStamp is zero then we have image data only, no
-		// time stamp is provided by the server;
-
-
-
-		// these functions just transfer/transform the image data into an openCv
-		// image sta structure and show them in a window
-		updateImageView(openCvImage_,recvImageData_, color_);
+void showDisplay(const unsigned char *frame, void *arg){
+	if(frame != NULL){
+		updateImageView(openCvImage_, (char *) frame, color_);
 		cvShowImage(winName_,openCvImage_);
-		waitKey(2);
 	};
-
-
-	delete dataSource_;
-	delete [] recvImageData_;
-	exit(0);
+	waitKey(1);
 };
 
-
-
 void updateImageView(IplImage *openCvImageRaw, char *imgD, int color){
 	if(color != 0){
-		for(int i = 0; i < imageHeight_; i++){
-			for(int j = 0; j < imageWidth_; j++){
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 0] =
-					imgD[3*((imageWidth_*i) + j) + 2]; // B
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 1] =
-					imgD[3*((imageWidth_*i) + j) + 1]; // G
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j*openCvImageRaw->nChannels + 2] =
-					imgD[3*((imageWidth_*i) + j) + 0]; // R
-			};
-		};
+		ImgKernels::rgbToBgr((uchar *) imgD, (uchar *) openCvImageRaw->imageData, openCvImageRaw->widthStep, openCvImageRaw->nChannels,
+				imageWidth_, imageHeight_);
 	}else{
-		for(int i = 0; i < imageHeight_; i++){
-			for(int j = 0; j < imageWidth_; j++){
-				((uchar *)(openCvImageRaw->imageData + i*openCvImageRaw->widthStep))[j] = imgD[(imageWidth_*i) + j];
-			};
-		};
+		ImgKernels::greyToPlane((uchar *) imgD, (uchar *) openCvImageRaw->imageData, openCvImageRaw->widthStep,
+				imageWidth_, imageHeight_);
 	};
 };
 
-bool updateImageData(TCPSocket *socket, char *storageImageData, int size){
-	int rcvBufferSize = size;
-	int idx = 0;
-	int bytesReceived = 0;
-	int totalBytesReceived = 0;
-	try{
-		socket->send(GET_IMAGE_DATA,strlen(GET_IMAGE_DATA));
-	}catch(SocketException &e){
-		cout << e.what();
-		return (false);
-	}catch(...){
-		cerr << "Error while sending: " << GET_IMAGE_DATA << endl;
-		return (false);
-	};
-
-	do{
-		bytesReceived = socket->recv(&(storageImageData[idx]),rcvBufferSize);
-		totalBytesReceived += bytesReceived;
-		idx = totalBytesReceived;
-	}while(totalBytesReceived < size);
-	return (true);
-};
-
-
-
-
 void printInfo(int argc, char *argv[]){
 		  if (argc == 3){
 			  return;
@@ -26,33 +26,24 @@
 #include <cstdlib>            // For atoi()
 
 #include "../include/StdImgDataServerProtocol.H"
+#include "../include/StdImgClient.H"
 
 //opencv
 #include <opencv2/opencv.hpp>
 
 using namespace cv;
 
-TCPSocket     *dataSource_ = NULL;
+StdImgClient  *dataSource_ = NULL;
 unsigned short SOURCE_SERVER_PORT_;
 char          *SOURCE_SERVER_ADR_;
 
 unsigned char *recvImageData_;
-int recvImageDataSize_;
-int imageWidth_;
-int imageHeight_;
-int color_;
-char imageOrg_;
-char ch1_;
-char ch2_;
-char ch3_;
-int nmbBytesTimeStamp_;
 
 
 
 void printInfo(int argc, char *argv[]);
 
 
-bool updateImageData(TCPSocket *socket, unsigned char *storageImageData, int size);
 //void updateImageView(IplImage *openCvImageRaw, char *imgD, int color);
 
 // just some interactive text outputs
@@ -84,64 +75,22 @@ int main(int argc, char *argv[]){
 
 	// client for image data
 	try{
-		dataSource_ = new TCPSocket(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
-	}catch(...){
-		cout << "No server for image data.\n" << SOURCE_SERVER_ADR_ << endl << endl;
+		dataSource_ = new StdImgClient(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
+	}catch(string msg){
+		cerr << msg << endl << endl;
 		exit(1);
 	};
+	cout << "Server version: " << dataSource_->version() << endl;
+	cout << "META_DATA received: " << dataSource_->metaDataText() << endl;
 
-
-	// get meta data
-	int sizeEchoBufferMetaData = 64;
-	char echoBufferMetaData[sizeEchoBufferMetaData];
-	int bytesReceived = 0;
-
-	try{
-		dataSource_->send(GET_VERSION,strlen(GET_VERSION));
-	}catch(...){
-		cerr << "Error while sending: " << GET_VERSION << endl;
-		exit(0);
-	};
-
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		cerr << "Can't get Standard Image Data Server Version, terminate process.\n";
-		exit(0);
-	};
-	echoBufferMetaData[bytesReceived]='\0';
-	cout << "Server version: " << echoBufferMetaData << endl;
-
-	echoBufferMetaData[0]='\0';
-	try{
-		dataSource_->send(GET_META_DATA,strlen(GET_META_DATA));
-	}catch(...){
-		cerr << "Error while sending: " << GET_META_DATA << endl;
-		exit(0);
-	};
-
-	if( (bytesReceived = dataSource_->recv(echoBufferMetaData,sizeEchoBufferMetaData)) <= 0){
-		cerr << "Can't get image meta data, terminate process.\n";
-		exit(0);
-	};
-	echoBufferMetaData[bytesReceived]='\0';
-	cout << "META_DATA received: " << echoBufferMetaData << endl;
-
-
-
-	// interpret received data
-	int nmbTokens = sscanf(echoBufferMetaData,"[W=%d,H=%d,O=%c,C=%d,X=%c%c%c,B=%d,BTS=%d]",
-			&imageWidth_,&imageHeight_,&imageOrg_,&color_,&ch1_,&ch2_,&ch3_,&recvImageDataSize_,&nmbBytesTimeStamp_);
-	if(nmbTokens != 9){
-		cerr << "Can't interpret image meta data, terminate process.\n";
-		exit(0);
-	};
-	// allocate memory for the image data with might include some bytes
-	// at the end containing the time stamp
-	recvImageData_ = new unsigned char[recvImageDataSize_ + nmbBytesTimeStamp_];
+	// memory for the image data with might include some bytes at the end
+	// containing the time stamp
+	recvImageData_ = new unsigned char[dataSource_->frameSize()];
 
 	int bloobCoordWidth = 0;
 	int bloobCoordHight = 0;
 
-	while(updateImageData(dataSource_,recvImageData_,(recvImageDataSize_ + nmbBytesTimeStamp_))){
+	while(dataSource_->receive(recvImageData_)){
 		bloobCoordWidth = 0;
 		bloobCoordHight = 0;
 
@@ -165,32 +114,6 @@ int main(int argc, char *argv[]){
 
 
 
-bool updateImageData(TCPSocket *socket, unsigned char *storageImageData, int size){
-	int rcvBufferSize = size;
-	int idx = 0;
-	int bytesReceived = 0;
-	int totalBytesReceived = 0;
-	try{
-		socket->send(GET_IMAGE_DATA,strlen(GET_IMAGE_DATA));
-	}catch(SocketException &e){
-		cout << e.what();
-		return (false);
-	}catch(...){
-		cerr << "Error while sending: " << GET_IMAGE_DATA << endl;
-		return (false);
-	};
-
-	do{
-		bytesReceived = socket->recv(&(storageImageData[idx]),rcvBufferSize);
-		totalBytesReceived += bytesReceived;
-		idx = totalBytesReceived;
-	}while(totalBytesReceived < size);
-	return (true);
-};
-
-
-
-
 void printInfo(int argc, char *argv[]){
 		  if (argc == 3){
 			  return;
@@ -0,0 +1,114 @@
+/*
+ * testFanInBlobDetector.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include <iostream>           // For cerr and cout
+#include <cstdlib>            // For atoi()
+#include <cstdio>
+
+#include "../include/BlobDetectorFanIn.H"
+
+void printInfo(int argc, char *argv[]);
+void printCompleteLicense(int argc, char* args[]);
+void printLicense(int argc, char* args[]);
+
+
+
+/**
+ *
+ * @param argc number of command line parameter
+ * @param *argv[] list of parameters
+ */
+int main(int argc, char *argv[]){
+
+	printInfo(argc,argv);
+
+	BlobDetector::BlobDetectorFanIn fanIn;
+	try{
+		for(int k = 1; k + 1 < argc; k += 2){
+			fanIn.add(argv[k], atoi(argv[k + 1]));
+		}
+		// the coordinates of all servers are received by one thread
+		fanIn.start();
+
+		int source;
+		BlobDetector::BlobCoord coord;
+		while(1){
+			if(!fanIn.waitNext(&source, &coord, 1000)){
+				int lost = 0;
+				for(int k = 0; k < fanIn.nmbSources(); k++){
+					if(fanIn.lost(k)) lost++;
+				}
+				if(lost == fanIn.nmbSources()){
+					throw string("Connections to all blob detectors lost.");
+				}
+				continue;
+			}
+			// the latest coordinates of all sources
+			for(int k = 0; k < fanIn.nmbSources(); k++){
+				if(fanIn.lost(k)){
+					printf("[%d] lost   ", k);
+				}else if(fanIn.latest(k, &coord)){
+					printf("[%d] %4d:%-4d frame %-6lu   ", k, coord.x, coord.y, coord.seq);
+				}else{
+					printf("[%d] -   ", k);
+				}
+			}
+			printf("\n");
+		}
+
+	}catch(string msg){
+		fanIn.stop();
+		cerr << msg << endl;
+		exit(1);
+	}
+}
+
+
+void printInfo(int argc, char *argv[]){
+		  if ((argc >= 3) && ((argc % 2) == 1)){
+			  return;
+		  }else if (argc == 2){
+			  printCompleteLicense(argc,argv);
+		  }else{     // Test for correct number of arguments
+		    cerr << "Usage of " << argv[0] << " : \n\n"
+		         << argv[0] << " <server host> <server port> [<server host> <server port> ...]" << endl;
+		    cerr << "\n"
+		    	 << "<server host>   hostname and port number of a \n"
+		    	 << "<server port>   running blob detector server, any number of them \n";
+		    printLicense(argc,argv);
+		  };
+};
+
+void printLicense(int argc, char* args[]){
+	char c;
+	cout << endl;
+    cout << "" << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+    cout << "" << "This is free software, and you are welcome to redistribute it\n";
+    cout << "" << "under certain conditions; type: \n";
+    cout << "" << "'" << args[0] << " license' for details.\n\n";
+    exit(0);
+};
+
+
+
+void printCompleteLicense(int argc, char* args[]){
+	cout << endl;
+	cout << "\t"<< "This program is free software: you can redistribute it and/or modify \n";
+	cout << "\t"<< "it under the terms of the GNU General Public License as published by \n";
+	cout << "\t"<< "the Free Software Foundation, either version 3 of the License, or \n";
+	cout << "\t"<< "(at your option) any later version. \n\n";
+
+	cout << "\t"<< "This program is distributed in the hope that it will be useful, \n";
+	cout << "\t"<< "but WITHOUT ANY WARRANTY; without even the implied warranty of \n";
+	cout << "\t"<< "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the \n";
+	cout << "\t"<< "GNU General Public License for more details. \n\n";
+
+	cout << "\t"<< "You might have received a copy of the GNU General Public License \n";
+	cout << "\t"<< "along with this program.  If not, see <http://www.gnu.org/licenses/>. \n\n";
+
+	exit(0);
+};
+
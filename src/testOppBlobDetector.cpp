@@ -43,11 +43,26 @@ int main(int argc, char *argv[]){
 		bd.connect(SOURCE_SERVER_ADR_, SOURCE_SERVER_PORT_);
 		cout << bd.version() << endl;
 
-		int x, y;
+		// the coordinates of every frame are pushed by the server instead
+		// of being requested in a loop
+		bd.startAsync();
+
+		BlobDetector::BlobCoord coord;
+		vector<Blob> blobs;
 		while(1){
-			bd.getBlobCoord(&x,&y);
-			if((x != 0) && (y != 0)){
-				cout << "(x,y): " << x << ":" << y << endl;
+			if(!bd.waitNext(&coord, 1000)){
+				if(bd.asyncLost()){
+					throw string("Connection to the blob detector lost.");
+				}
+				continue;
+			}
+			if((coord.x != 0) && (coord.y != 0)){
+				cout << "(x,y): " << coord.x << ":" << coord.y << "  frame " << coord.seq << endl;
+				bd.getBlobs(&blobs);
+				for(size_t k = 0; k < blobs.size(); k++){
+					cout << "    blob " << k << ": (" << blobs[k].centroidX << "," << blobs[k].centroidY
+					     << ") area " << blobs[k].area << endl;
+				}
 			}
 		}
 